@@ -0,0 +1,594 @@
+#ifndef CPPTOOLS_CONTAINER_COMPACT_TREE_HPP
+#define CPPTOOLS_CONTAINER_COMPACT_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/iterator_exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/utility/detail/allocator.hpp>
+
+#include "tree/traversal.hpp"
+
+#ifndef CPPTOOLS_DEBUG_COMPACT_TREE
+# define CPPTOOLS_DEBUG_COMPACT_TREE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
+#endif
+
+#define CPPTOOLS_I_HAVE_INCLUDED_UNDEF_DEBUG_MACROS_LATER_ON_IN_THIS_FILE
+#define CPPTOOLS_LOCAL_DEBUG_MACRO CPPTOOLS_DEBUG_COMPACT_TREE
+#include <cpptools/_internal/debug_macros.hpp>
+
+namespace tools {
+
+template<typename T, typename A>
+class compact_tree;
+
+namespace detail {
+
+/// @brief Forward iterator implementing DFS traversal of a compact_tree.
+/// @tparam Tree Type of tree to be traversed, possibly const-qualified
+/// @tparam O Order of traversal to be implemented by the iterator
+/// @note Iterators are invalidated by any erasure in the tree.
+template<typename Tree, order_t O>
+class compact_dfs_iterator {
+    template<typename Tree2, order_t O2>
+    friend class compact_dfs_iterator;
+
+    template<typename Tree2, order_t O2>
+    friend class compact_dfs_proxy;
+
+    using order_tag_t = order_tag<O>;
+
+public:
+    using node_id           = typename std::remove_const_t<Tree>::node_id;
+    using value_type        = typename std::remove_const_t<Tree>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = std::conditional_t<std::is_const_v<Tree>, const value_type&, value_type&>;
+    using pointer           = std::conditional_t<std::is_const_v<Tree>, const value_type*, value_type*>;
+    using iterator_category = std::forward_iterator_tag;
+
+private:
+    /// @brief Pointer to the tree being traversed
+    Tree* _tree;
+
+    /// @brief ID of the node currently being iterated over
+    /// @note If _node is npos, then this iterator is a past-the-end iterator.
+    node_id _node;
+
+    compact_dfs_iterator(Tree* tree, node_id node) noexcept :
+        _tree(tree),
+        _node(node)
+    {
+
+    }
+
+public:
+    compact_dfs_iterator() noexcept :
+        _tree(nullptr),
+        _node(Tree::npos)
+    {
+
+    }
+
+    template<typename Tree2> requires std::is_same_v<const Tree2, Tree>
+    compact_dfs_iterator(const compact_dfs_iterator<Tree2, O>& other) noexcept :
+        _tree(other._tree),
+        _node(other._node)
+    {
+
+    }
+
+    compact_dfs_iterator& operator++() CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(not_null(_tree),          "compact_tree", critical, "cannot prefix-increment a default-constructed iterator", exception::iterator::incremented_past_end_error);
+        CPPTOOLS_DEBUG_ASSERT(_node != Tree::npos,      "compact_tree", critical, "cannot prefix-increment a past-the-end iterator",        exception::iterator::incremented_past_end_error);
+
+        _node = _tree->dfs_next(_node, order_tag_t{});
+
+        return *this;
+    }
+
+    compact_dfs_iterator operator++(int) CPPTOOLS_NOEXCEPT_RELEASE {
+        compact_dfs_iterator tmp = *this;
+        ++*this;
+
+        return tmp;
+    }
+
+    reference operator*() const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_node != Tree::npos, "compact_tree", critical, "cannot dereference an iterator pointing at no node", exception::iterator::illegal_dereference_error);
+
+        return (*_tree)[_node];
+    }
+
+    pointer operator->() const CPPTOOLS_NOEXCEPT_RELEASE {
+        return &(**this);
+    }
+
+    bool operator==(const compact_dfs_iterator& rhs) const noexcept {
+        return (_node == rhs._node)
+            && (_tree == rhs._tree);
+    }
+
+    /// @brief Get the ID of the node currently being iterated over
+    node_id id() const noexcept {
+        return _node;
+    }
+};
+
+template<typename Tree, order_t O>
+class compact_dfs_proxy {
+    using order_tag_t = order_tag<O>;
+
+    Tree& _tree;
+
+public:
+    compact_dfs_proxy(Tree& tree) noexcept : _tree(tree) {}
+
+    using iterator = compact_dfs_iterator<Tree, O>;
+
+    iterator begin() const noexcept {
+        return iterator(&_tree, _tree.dfs_begin(order_tag_t{}));
+    }
+
+    iterator end() const noexcept {
+        return iterator(&_tree, Tree::npos);
+    }
+};
+
+} // namespace detail
+
+/// @brief An arbitrary tree whose nodes are stored contiguously and refer to
+/// one another through 32-bit indices (parent, first and last child, next
+/// sibling), which amounts to 16 bytes of structural overhead per node. The
+/// last child index makes appending a child constant-time. Being made of
+/// plain indices into vectors, the tree can be relocated or copied in bulk.
+/// @tparam T Type of values to be stored
+/// @tparam A Allocator type
+/// @note Node IDs remain valid across insertions, but any erasure compacts
+/// the storage and invalidates all node IDs and iterators.
+/// @note Enable debug assertions with #define CPPTOOLS_DEBUG_COMPACT_TREE 1
+template<typename T, typename A = std::allocator<T>>
+class compact_tree {
+public:
+    using value_type      = T;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using allocator_type  = A;
+    using node_id         = std::uint32_t;
+
+    /// @brief Node ID used to signify the absence of a node
+    static constexpr node_id npos = std::numeric_limits<node_id>::max();
+
+private:
+    /// @brief Structural information of a node
+    struct _link {
+        node_id parent;
+        node_id first_child;
+        node_id last_child;
+        node_id next_sibling;
+    };
+
+    static_assert(sizeof(_link) == 4 * sizeof(node_id), "structural overhead should be exactly four node IDs per node");
+
+    using _value_storage_t = std::vector<T, detail::rebind_alloc_t<A, T>>;
+    using _link_storage_t  = std::vector<_link, detail::rebind_alloc_t<A, _link>>;
+    using _id_storage_t    = std::vector<node_id, detail::rebind_alloc_t<A, node_id>>;
+
+public:
+    using size_type       = typename _value_storage_t::size_type;
+    using difference_type = typename _value_storage_t::difference_type;
+    using pointer         = typename _value_storage_t::pointer;
+    using const_pointer   = typename _value_storage_t::const_pointer;
+    using iterator        = typename _value_storage_t::iterator;
+    using const_iterator  = typename _value_storage_t::const_iterator;
+
+    struct initializer {
+        T value;
+        std::vector<initializer> child_initializers;
+
+        initializer(const T& value, std::vector<initializer> child_init = {}) :
+            value(value),
+            child_initializers(std::move(child_init))
+        {
+        }
+    };
+
+private:
+    /// @brief Values of the nodes, indexed by node ID
+    _value_storage_t _values;
+
+    /// @brief Structure of the nodes, indexed by node ID
+    _link_storage_t _links;
+
+    /// @brief New IDs of the nodes while an erasure compacts the storage,
+    /// kept across erasures to reuse its storage
+    _id_storage_t _remap;
+
+    /// @brief Append a new node to the storage, without linking it
+    template<typename... ArgTypes>
+    node_id _push_node(node_id parent, ArgTypes&&... args) {
+        CPPTOOLS_DEBUG_ASSERT(_values.size() < npos, "compact_tree", critical, "node IDs exhausted", exception::parameter::invalid_value_error, "size", _values.size());
+
+        _values.emplace_back(std::forward<ArgTypes>(args)...);
+        _links.push_back({ parent, npos, npos, npos });
+
+        return static_cast<node_id>(_values.size() - 1);
+    }
+
+    void _fill_from_init(node_id dest, const std::vector<initializer>& child_initializers) {
+        node_id previous = npos;
+        for (const auto& init : child_initializers) {
+            node_id child = _push_node(dest, init.value);
+            _link_after(dest, previous, child);
+            previous = child;
+
+            _fill_from_init(child, init.child_initializers);
+        }
+    }
+
+    /// @brief Link a node as the next sibling of another, or as the first
+    /// child of its parent, making it the last child of its parent
+    void _link_after(node_id parent, node_id previous, node_id n) noexcept {
+        if (previous == npos) {
+            _links[parent].first_child = n;
+        } else {
+            _links[previous].next_sibling = n;
+        }
+
+        _links[parent].last_child = n;
+    }
+
+    /// @brief Get the ID of the leftmost leaf under a node, the node itself
+    /// if it has no children
+    node_id _leftmost_child_or_this(node_id n) const noexcept {
+        while (_links[n].first_child != npos) {
+            n = _links[n].first_child;
+        }
+
+        return n;
+    }
+
+public:
+    compact_tree(allocator_type alloc = {}) :
+        _values(alloc),
+        _links(alloc),
+        _remap(alloc)
+    {
+
+    }
+
+    /// @param init Tree-like initializer list
+    compact_tree(const initializer& init, allocator_type alloc = {}) :
+        compact_tree(std::move(alloc))
+    {
+        node_id root = _push_node(npos, init.value);
+        _fill_from_init(root, init.child_initializers);
+    }
+
+    compact_tree(const compact_tree& other) = default;
+    compact_tree(compact_tree&& other) noexcept = default;
+    compact_tree& operator=(const compact_tree& other) = default;
+    compact_tree& operator=(compact_tree&& other) noexcept = default;
+
+    /// @brief Get the allocator instance for this tree
+    allocator_type get_allocator() const {
+        return static_cast<allocator_type>(_values.get_allocator());
+    }
+
+    /// @brief Reserve storage for a given amount of nodes
+    void reserve(size_type capacity) {
+        _values.reserve(capacity);
+        _links.reserve(capacity);
+    }
+
+    /// @brief Get the ID of the root node, npos if the tree is empty
+    node_id root() const noexcept {
+        return _values.empty() ? npos : 0;
+    }
+
+    /// @brief Get the ID of the parent of a node, npos if it has none
+    node_id parent(node_id n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _links[n].parent;
+    }
+
+    /// @brief Get the ID of the first child of a node, npos if it has none
+    node_id first_child(node_id n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _links[n].first_child;
+    }
+
+    /// @brief Get the ID of the last child of a node, npos if it has none
+    node_id last_child(node_id n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _links[n].last_child;
+    }
+
+    /// @brief Get the ID of the sibling right of a node, npos if it has none
+    node_id next_sibling(node_id n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _links[n].next_sibling;
+    }
+
+    /// @brief Get the amount of children of a node
+    /// @note This walks the children of the node.
+    size_type child_count(node_id n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        size_type count = 0;
+        for (node_id child = _links[n].first_child; child != npos; child = _links[child].next_sibling) {
+            ++count;
+        }
+
+        return count;
+    }
+
+    reference operator[](node_id n) CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _values.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _values[n];
+    }
+
+    const_reference operator[](node_id n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < _values.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _values[n];
+    }
+
+    /// @brief Construct a new node as the last child of another
+    /// @param where ID of the parent node, npos to create the root of an
+    /// empty tree
+    /// @param args Arguments to be forwarded to the constructor of the value
+    /// @return The ID of the new node
+    /// @exception tools::exception::parameter::invalid_value_error \c where
+    /// is npos but the tree already has a root.
+    template<typename... ArgTypes>
+    node_id emplace_node(node_id where, ArgTypes&&... args) {
+        CPPTOOLS_DEBUG_ASSERT(where == npos || where < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "where", where);
+
+        if (where == npos) {
+            if (!empty()) {
+                CPPTOOLS_THROW(exception::parameter::invalid_value_error, "where", where).with_message("the tree already has a root");
+            }
+
+            return _push_node(npos, std::forward<ArgTypes>(args)...);
+        }
+
+        node_id previous = _links[where].last_child;
+        node_id n = _push_node(where, std::forward<ArgTypes>(args)...);
+        _link_after(where, previous, n);
+
+        return n;
+    }
+
+    /// @brief Erase a node and all of its descendants
+    /// @param subtree_root ID of the root of the subtree to erase
+    /// @note The storage is compacted in a single linear pass, which
+    /// invalidates all node IDs.
+    void erase_subtree(node_id subtree_root) {
+        CPPTOOLS_DEBUG_ASSERT(subtree_root < _links.size(), "compact_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+
+        node_id parent = _links[subtree_root].parent;
+        if (parent == npos) {
+            clear();
+            return;
+        }
+
+        // unlink the subtree
+        node_id next = _links[subtree_root].next_sibling;
+        node_id previous = npos;
+        if (_links[parent].first_child == subtree_root) {
+            _links[parent].first_child = next;
+        } else {
+            previous = _links[parent].first_child;
+            while (_links[previous].next_sibling != subtree_root) {
+                previous = _links[previous].next_sibling;
+            }
+
+            _links[previous].next_sibling = next;
+        }
+        if (next == npos) {
+            _links[parent].last_child = previous;
+        }
+        _links[subtree_root].next_sibling = npos;
+
+        // mark erased nodes
+        _remap.assign(_links.size(), 0);
+        for (node_id n = subtree_root; n != npos; n = _dfs_next_in(subtree_root, n)) {
+            _remap[n] = npos;
+        }
+
+        // assign new IDs to remaining nodes, in storage order
+        node_id new_size = 0;
+        for (auto& id : _remap) {
+            if (id != npos) {
+                id = new_size++;
+            }
+        }
+
+        auto translate = [&](node_id n) { return (n == npos) ? npos : _remap[n]; };
+
+        for (node_id n = 0; n < _remap.size(); ++n) {
+            node_id target = _remap[n];
+            if (target == npos) {
+                continue;
+            }
+
+            _link& link = _links[n];
+            _links[target] = { translate(link.parent), translate(link.first_child), translate(link.last_child), translate(link.next_sibling) };
+
+            if (target != n) {
+                _values[target] = std::move(_values[n]);
+            }
+        }
+
+        _remap.clear();
+        _values.erase(_values.begin() + new_size, _values.end());
+        _links.resize(new_size);
+    }
+
+    /// @brief Get the amount of nodes in the tree
+    size_type size() const noexcept {
+        return _values.size();
+    }
+
+    /// @brief Get the maximum size the tree can have
+    size_type max_size() const noexcept {
+        return std::min<size_type>(_values.max_size(), npos);
+    }
+
+    /// @brief Get whether the tree is empty
+    bool empty() const noexcept {
+        return _values.empty();
+    }
+
+    /// @brief Clear the tree
+    void clear() noexcept {
+        _values.clear();
+        _links.clear();
+    }
+
+    /// @brief Check whether this tree and another have the same structure
+    /// and values
+    bool operator==(const compact_tree& other) const {
+        if (size() != other.size()) {
+            return false;
+        }
+
+        // in pre-order, the values along with whether each node has children
+        // and a right sibling fully determine the tree
+        node_id lhs = root();
+        node_id rhs = other.root();
+        while (lhs != npos) {
+            const _link& l = _links[lhs];
+            const _link& r = other._links[rhs];
+
+            if ((l.first_child == npos) != (r.first_child == npos)
+             || (l.next_sibling == npos) != (r.next_sibling == npos)
+             || !(_values[lhs] == other._values[rhs])) {
+                return false;
+            }
+
+            lhs = dfs_next(lhs, detail::pre_order_tag{});
+            rhs = other.dfs_next(rhs, detail::pre_order_tag{});
+        }
+
+        return true;
+    }
+
+    friend void swap(compact_tree& lhs, compact_tree& rhs) noexcept {
+        std::swap(lhs._values, rhs._values);
+        std::swap(lhs._links, rhs._links);
+        std::swap(lhs._remap, rhs._remap);
+    }
+
+    /// @brief Get the ID of the first node in a DFS traversal of the tree
+    node_id dfs_begin(detail::pre_order_tag) const noexcept {
+        return root();
+    }
+
+    /// @copydoc compact_tree::dfs_begin
+    node_id dfs_begin(detail::post_order_tag) const noexcept {
+        return empty() ? npos : _leftmost_child_or_this(0);
+    }
+
+    /// @brief Get the ID of the node following another in a pre-order
+    /// traversal of the tree, npos if there is none
+    node_id dfs_next(node_id n, detail::pre_order_tag) const noexcept {
+        return _dfs_next_in(npos, n);
+    }
+
+    /// @brief Get the ID of the node following another in a post-order
+    /// traversal of the tree, npos if there is none
+    node_id dfs_next(node_id n, detail::post_order_tag) const noexcept {
+        const _link& link = _links[n];
+
+        return (link.next_sibling != npos)
+            ? _leftmost_child_or_this(link.next_sibling)
+            : link.parent;
+    }
+
+private:
+    /// @brief Get the ID of the node following another in a pre-order
+    /// traversal of a subtree
+    /// @param subtree_root Root of the subtree being traversed, npos to
+    /// traverse the whole tree
+    node_id _dfs_next_in(node_id subtree_root, node_id n) const noexcept {
+        if (_links[n].first_child != npos) {
+            return _links[n].first_child;
+        }
+
+        while (n != subtree_root) {
+            if (_links[n].next_sibling != npos) {
+                return _links[n].next_sibling;
+            }
+
+            n = _links[n].parent;
+        }
+
+        return npos;
+    }
+
+public:
+    /// @brief Iterate over values in storage order
+    iterator begin() noexcept {
+        return _values.begin();
+    }
+
+    /// @copydoc compact_tree::begin
+    iterator end() noexcept {
+        return _values.end();
+    }
+
+    /// @copydoc compact_tree::begin
+    const_iterator begin() const noexcept {
+        return _values.begin();
+    }
+
+    /// @copydoc compact_tree::begin
+    const_iterator end() const noexcept {
+        return _values.end();
+    }
+
+    /// @copydoc compact_tree::begin
+    const_iterator cbegin() const noexcept {
+        return _values.cbegin();
+    }
+
+    /// @copydoc compact_tree::begin
+    const_iterator cend() const noexcept {
+        return _values.cend();
+    }
+
+    /// @brief Get a proxy range-like object which implements DFS const
+    /// traversal of the tree. To be used with range-based \c for loops.
+    template<traversal::order O>
+    friend detail::compact_dfs_proxy<const compact_tree, O> dfs(const compact_tree& t) {
+        return { t };
+    }
+
+    /// @brief Get a proxy range-like object which implements DFS traversal of
+    /// the tree. To be used with range-based \c for loops.
+    template<traversal::order O>
+    friend detail::compact_dfs_proxy<compact_tree, O> dfs(compact_tree& t) {
+        return { t };
+    }
+};
+
+} // namespace tools
+
+#include <cpptools/_internal/undef_debug_macros.hpp>
+
+#endif//CPPTOOLS_CONTAINER_COMPACT_TREE_HPP
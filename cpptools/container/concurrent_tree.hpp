@@ -0,0 +1,324 @@
+#ifndef CPPTOOLS_CONTAINER_CONCURRENT_TREE_HPP
+#define CPPTOOLS_CONTAINER_CONCURRENT_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/internal_exception.hpp>
+
+#include "persistent_tree.hpp"
+
+#ifndef CPPTOOLS_DEBUG_CONCURRENT_TREE
+# define CPPTOOLS_DEBUG_CONCURRENT_TREE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
+#endif
+
+#define CPPTOOLS_I_HAVE_INCLUDED_UNDEF_DEBUG_MACROS_LATER_ON_IN_THIS_FILE
+#define CPPTOOLS_LOCAL_DEBUG_MACRO CPPTOOLS_DEBUG_CONCURRENT_TREE
+#include <cpptools/_internal/debug_macros.hpp>
+
+namespace tools {
+
+/// @brief A tree read by many threads and written by few, RCU-style. Writers
+/// mutate a private version of the tree and publish it atomically; readers
+/// traverse the last published version without taking any lock nor touching
+/// any shared reference count. Versions replaced by a newer one are
+/// reclaimed once no reader can still be traversing them, which is tracked
+/// through epochs announced by readers.
+/// @tparam T Type of values to be stored, must be copy-constructible
+/// @tparam A Allocator type
+/// @note Versions share their unmodified nodes (see persistent_tree): a
+/// publication costs memory proportional to the changes it carries.
+/// @note Enable debug assertions with #define CPPTOOLS_DEBUG_CONCURRENT_TREE 1
+template<typename T, typename A = std::allocator<T>>
+class concurrent_tree {
+public:
+    using version_type   = persistent_tree<T, A>;
+    using value_type     = T;
+    using allocator_type = A;
+    using size_type      = typename version_type::size_type;
+    using path           = typename version_type::path;
+
+private:
+    using _epoch_t = std::uint64_t;
+
+    /// @brief Epoch announced by a quiescent reader
+    static constexpr _epoch_t _quiescent = 0;
+
+    /// @brief Announcement board of a reader, alone on its cache line so that
+    /// readers do not contend with one another
+    /// @note std::hardware_destructive_interference_size is not ABI-stable,
+    /// the common cache line size is used instead.
+    struct alignas(64) _reader_slot {
+        /// @brief Epoch at which the reader started its current read,
+        /// _quiescent if it is not reading
+        std::atomic<_epoch_t> epoch = _quiescent;
+
+        /// @brief Whether a reader object currently uses this slot
+        bool claimed = false;
+    };
+
+    /// @brief Version replaced by a newer one, along with the epoch at which
+    /// it was replaced
+    struct _retired_version {
+        std::unique_ptr<const version_type> version;
+        _epoch_t epoch;
+    };
+
+    /// @brief Last published version
+    std::atomic<const version_type*> _published;
+
+    /// @brief Current epoch, advanced on every publication
+    std::atomic<_epoch_t> _epoch;
+
+    /// @brief Version being edited by writers, sharing its nodes with the
+    /// published one
+    version_type _staged;
+
+    /// @brief Serializes writers
+    std::mutex _write_mutex;
+
+    /// @brief Versions which readers may still be traversing
+    std::vector<_retired_version> _retired;
+
+    /// @brief Announcement boards of all readers, which never move so that
+    /// readers can keep pointers to them
+    std::vector<std::unique_ptr<_reader_slot>> _slots;
+
+    /// @brief Guards the list of reader slots, only taken when a reader is
+    /// created or destroyed and by writers when reclaiming versions
+    mutable std::mutex _slots_mutex;
+
+    /// @brief Free the retired versions which no reader can be traversing
+    /// @pre The write mutex must be held.
+    void _reclaim() {
+        if (_retired.empty()) {
+            return;
+        }
+
+        // a reader which announced an epoch after a version was retired
+        // loaded the published version after that version was replaced
+        _epoch_t oldest_reader = _quiescent;
+        {
+            std::scoped_lock lock(_slots_mutex);
+            for (const auto& slot : _slots) {
+                _epoch_t e = slot->epoch.load(std::memory_order_seq_cst);
+                if (e != _quiescent && (oldest_reader == _quiescent || e < oldest_reader)) {
+                    oldest_reader = e;
+                }
+            }
+        }
+
+        std::erase_if(_retired, [oldest_reader](const _retired_version& r) {
+            return oldest_reader == _quiescent || r.epoch < oldest_reader;
+        });
+    }
+
+    /// @brief Publish the staged version
+    /// @pre The write mutex must be held.
+    void _publish() {
+        auto next = std::make_unique<const version_type>(_staged.snapshot());
+        const version_type* previous = _published.exchange(next.release(), std::memory_order_seq_cst);
+
+        // readers which announce the new epoch are bound to see the new version
+        const _epoch_t retired_at = _epoch.fetch_add(1, std::memory_order_seq_cst);
+        _retired.push_back({ std::unique_ptr<const version_type>(previous), retired_at });
+
+        _reclaim();
+    }
+
+    _reader_slot* _claim_slot() {
+        std::scoped_lock lock(_slots_mutex);
+        for (auto& slot : _slots) {
+            if (!slot->claimed) {
+                slot->claimed = true;
+                return slot.get();
+            }
+        }
+
+        _slots.push_back(std::make_unique<_reader_slot>());
+        _slots.back()->claimed = true;
+
+        return _slots.back().get();
+    }
+
+    void _release_slot(_reader_slot* slot) {
+        std::scoped_lock lock(_slots_mutex);
+        slot->claimed = false;
+    }
+
+public:
+    class reader;
+
+    /// @brief Scope during which a reader traverses a published version.
+    /// The version stays valid until the guard is destroyed.
+    class read_guard {
+        friend class reader;
+
+        _reader_slot* _slot;
+        const version_type* _version;
+
+        read_guard(_reader_slot* slot, const version_type* version) noexcept :
+            _slot(slot),
+            _version(version)
+        {
+
+        }
+
+    public:
+        read_guard(const read_guard& other) = delete;
+        read_guard& operator=(const read_guard& other) = delete;
+
+        read_guard(read_guard&& other) noexcept :
+            _slot(std::exchange(other._slot, nullptr)),
+            _version(std::exchange(other._version, nullptr))
+        {
+
+        }
+
+        read_guard& operator=(read_guard&& other) = delete;
+
+        ~read_guard() {
+            if (_slot != nullptr) {
+                _slot->epoch.store(_quiescent, std::memory_order_release);
+            }
+        }
+
+        const version_type& operator*() const noexcept {
+            return *_version;
+        }
+
+        const version_type* operator->() const noexcept {
+            return _version;
+        }
+    };
+
+    /// @brief Handle through which one thread reads the tree. Creating one
+    /// takes a lock, reading does not.
+    /// @note A reader must only be used by one thread at a time, and hold at
+    /// most one read guard at a time.
+    class reader {
+        friend class concurrent_tree;
+
+        concurrent_tree* _tree;
+        _reader_slot* _slot;
+
+        explicit reader(concurrent_tree& tree) :
+            _tree(&tree),
+            _slot(tree._claim_slot())
+        {
+
+        }
+
+    public:
+        reader(const reader& other) = delete;
+        reader& operator=(const reader& other) = delete;
+
+        reader(reader&& other) noexcept :
+            _tree(std::exchange(other._tree, nullptr)),
+            _slot(std::exchange(other._slot, nullptr))
+        {
+
+        }
+
+        reader& operator=(reader&& other) noexcept {
+            std::swap(_tree, other._tree);
+            std::swap(_slot, other._slot);
+
+            return *this;
+        }
+
+        ~reader() {
+            if (_slot != nullptr) {
+                _tree->_release_slot(_slot);
+            }
+        }
+
+        /// @brief Start traversing the last published version of the tree
+        /// @return A guard giving access to the version, which must not
+        /// outlive this reader
+        read_guard read() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(_slot->epoch.load(std::memory_order_relaxed) == _quiescent, "concurrent_tree", critical, "reader already holds a read guard", exception::internal::precondition_failure_error);
+
+            // announce the epoch before loading the version: a writer which
+            // does not see the announcement published its version before the
+            // load
+            _slot->epoch.store(_tree->_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            const version_type* version = _tree->_published.load(std::memory_order_seq_cst);
+
+            return read_guard(_slot, version);
+        }
+    };
+
+    concurrent_tree(allocator_type alloc = {}) :
+        concurrent_tree(version_type(std::move(alloc)))
+    {
+
+    }
+
+    /// @param initial Version to be published initially
+    explicit concurrent_tree(version_type initial) :
+        _published(nullptr),
+        _epoch(1),
+        _staged(std::move(initial)),
+        _write_mutex(),
+        _retired(),
+        _slots(),
+        _slots_mutex()
+    {
+        _published.store(new version_type(_staged.snapshot()), std::memory_order_release);
+    }
+
+    concurrent_tree(const concurrent_tree& other) = delete;
+    concurrent_tree& operator=(const concurrent_tree& other) = delete;
+
+    /// @pre No reader of this tree must remain.
+    ~concurrent_tree() {
+        delete _published.load(std::memory_order_acquire);
+    }
+
+    /// @brief Create a handle through which a thread can read the tree
+    reader make_reader() {
+        return reader(*this);
+    }
+
+    /// @brief Apply a batch of mutations to the tree and publish them
+    /// atomically: readers see either none or all of them
+    /// @param f Callable to be invoked with a reference to the version to
+    /// mutate, which starts out equal to the last published one
+    /// @note Writers are serialized. Readers are never blocked.
+    /// @note If \c f throws, the mutations it made are kept and will be
+    /// published along with the next batch.
+    template<typename F>
+    void update(F&& f) {
+        std::scoped_lock lock(_write_mutex);
+
+        std::forward<F>(f)(_staged);
+        _publish();
+    }
+
+    /// @brief Free the replaced versions which no reader is traversing
+    /// anymore
+    /// @note This is done on every publication as well.
+    void reclaim() {
+        std::scoped_lock lock(_write_mutex);
+        _reclaim();
+    }
+
+    /// @brief Get the amount of replaced versions awaiting reclamation
+    size_type pending_reclamation() {
+        std::scoped_lock lock(_write_mutex);
+        return _retired.size();
+    }
+};
+
+} // namespace tools
+
+#include <cpptools/_internal/undef_debug_macros.hpp>
+
+#endif//CPPTOOLS_CONTAINER_CONCURRENT_TREE_HPP
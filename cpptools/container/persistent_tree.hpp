@@ -0,0 +1,548 @@
+#ifndef CPPTOOLS_CONTAINER_PERSISTENT_TREE_HPP
+#define CPPTOOLS_CONTAINER_PERSISTENT_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/iterator_exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/utility/detail/allocator.hpp>
+
+#ifndef CPPTOOLS_DEBUG_PERSISTENT_TREE
+# define CPPTOOLS_DEBUG_PERSISTENT_TREE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
+#endif
+
+#define CPPTOOLS_I_HAVE_INCLUDED_UNDEF_DEBUG_MACROS_LATER_ON_IN_THIS_FILE
+#define CPPTOOLS_LOCAL_DEBUG_MACRO CPPTOOLS_DEBUG_PERSISTENT_TREE
+#include <cpptools/_internal/debug_macros.hpp>
+
+namespace tools {
+
+/// @brief An arbitrary tree whose versions share their unmodified nodes.
+/// Copying the tree, or taking a snapshot of it, is O(1). A mutation only
+/// copies the nodes on the path from the root to the node it modifies, and
+/// only those which are shared with another version: other versions never
+/// observe it, and a snapshot costs memory proportional to the changes made
+/// after it was taken.
+/// @tparam T Type of values to be stored, must be copy-constructible
+/// @tparam A Allocator type
+/// @note Nodes have no parent pointers, so they are designated by their path
+/// from the root: the index of a child of the root, then that of one of its
+/// children, and so on. The empty path designates the root.
+/// @note A single version must not be used from several threads at once,
+/// but distinct versions can: a snapshot can be handed over to a reader
+/// thread and traversed there, without locking, while the tree it was taken
+/// from keeps being mutated.
+/// @note Enable debug assertions with #define CPPTOOLS_DEBUG_PERSISTENT_TREE 1
+template<typename T, typename A = std::allocator<T>>
+class persistent_tree {
+public:
+    using value_type      = T;
+    using const_reference = const value_type&;
+    using const_pointer   = const value_type*;
+    using allocator_type  = A;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using path            = std::vector<size_type>;
+
+    struct initializer {
+        T value;
+        std::vector<initializer> child_initializers;
+
+        initializer(const T& value, std::vector<initializer> child_init = {}) :
+            value(value),
+            child_initializers(std::move(child_init))
+        {
+        }
+    };
+
+private:
+    struct _node;
+
+    /// @brief Nodes are immutable once shared, and thus only ever pointed to
+    /// as const. Nodes are never created const, so that a node pointed to
+    /// from a single place can be mutated in place.
+    using _node_ptr   = std::shared_ptr<const _node>;
+    using _children_t = std::vector<_node_ptr, detail::rebind_alloc_t<A, _node_ptr>>;
+
+    struct _node {
+        T value;
+        _children_t children;
+
+        /// @brief Amount of nodes in the subtree rooted in this node
+        size_type size;
+
+        template<typename... ArgTypes>
+        _node(const allocator_type& alloc, ArgTypes&&... args) :
+            value(std::forward<ArgTypes>(args)...),
+            children(alloc),
+            size(1)
+        {
+
+        }
+
+        _node(const _node& other) = default;
+
+        /// @brief Destroy the nodes this node was the last owner of without
+        /// recursing, so that dropping a deep tree cannot overflow the stack,
+        /// whichever owner happens to drop it last
+        ~_node() {
+            _children_t pending = std::move(children);
+
+            while (!pending.empty()) {
+                _node_ptr n = std::move(pending.back());
+                pending.pop_back();
+
+                // the node is exclusive to this destructor: detach its
+                // children before it is destroyed at the end of the iteration
+                if (_exclusive(n)) {
+                    auto& grandchildren = const_cast<_node&>(*n).children;
+                    std::move(grandchildren.begin(), grandchildren.end(), std::back_inserter(pending));
+                    grandchildren.clear();
+                }
+            }
+        }
+    };
+
+    /// @brief Root of this version of the tree
+    _node_ptr _root;
+
+    allocator_type _alloc;
+
+    template<typename... ArgTypes>
+    _node_ptr _make_node(ArgTypes&&... args) const {
+        return std::allocate_shared<_node>(_alloc, _alloc, std::forward<ArgTypes>(args)...);
+    }
+
+    _node_ptr _make_from_init(const initializer& init) const {
+        auto n = _make_node(init.value);
+        auto& mut = const_cast<_node&>(*n);
+
+        mut.children.reserve(init.child_initializers.size());
+        for (const auto& child_init : init.child_initializers) {
+            mut.children.push_back(_make_from_init(child_init));
+            mut.size += mut.children.back()->size;
+        }
+
+        return n;
+    }
+
+    /// @brief Get the node designated by a path
+    const _node* _find(const path& p) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(!empty(), "persistent_tree", critical, "tree is empty", exception::parameter::invalid_value_error, "p", p.size());
+
+        const _node* n = _root.get();
+        for (size_type index : p) {
+            CPPTOOLS_DEBUG_ASSERT(index < n->children.size(), "persistent_tree", critical, "path leads out of the tree", exception::parameter::invalid_value_error, "index", index);
+
+            n = n->children[index].get();
+        }
+
+        return n;
+    }
+
+    /// @brief Tell whether a node is pointed to from a single place, and thus
+    /// reachable from no other version
+    /// @note Other threads may have dropped their references to the node just
+    /// before: their reads of the node must happen before it is mutated.
+    static bool _exclusive(const _node_ptr& n) noexcept {
+        if (n.use_count() != 1) {
+            return false;
+        }
+
+        // use_count() is a relaxed load, pair it with the release decrement
+        // of the last other owner
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return true;
+    }
+
+    /// @brief Make the node pointed to by a pointer exclusive to this version
+    /// @return The node, which can be mutated
+    _node* _unshare(_node_ptr& slot) {
+        if (!_exclusive(slot)) {
+            slot = std::allocate_shared<_node>(_alloc, *slot);
+        }
+
+        return const_cast<_node*>(slot.get());
+    }
+
+    /// @brief Make all nodes along a path exclusive to this version
+    /// @param p Path to the node to be mutated
+    /// @return The node at the end of the path, which can be mutated
+    /// @note Nodes copied before an allocation failure stay copied, which
+    /// leaves this version unchanged.
+    _node* _unshare_path(const path& p) {
+        CPPTOOLS_DEBUG_ASSERT(!empty(), "persistent_tree", critical, "tree is empty", exception::parameter::invalid_value_error, "p", p.size());
+
+        _node* n = _unshare(_root);
+        for (size_type index : p) {
+            CPPTOOLS_DEBUG_ASSERT(index < n->children.size(), "persistent_tree", critical, "path leads out of the tree", exception::parameter::invalid_value_error, "index", index);
+
+            n = _unshare(n->children[index]);
+        }
+
+        return n;
+    }
+
+    /// @brief Reflect a change in the size of a subtree in the subtree sizes
+    /// of all nodes along the path to it
+    /// @pre All nodes along the path must be exclusive to this version.
+    void _resize_path(const path& p, difference_type delta) noexcept {
+        auto n = const_cast<_node*>(_root.get());
+        n->size += static_cast<size_type>(delta);
+
+        for (size_type index : p) {
+            n = const_cast<_node*>(n->children[index].get());
+            n->size += static_cast<size_type>(delta);
+        }
+    }
+
+public:
+    /// @brief Read-only view of a node, valid for as long as the version of
+    /// the tree it was obtained from is alive
+    class node_view {
+        friend class persistent_tree;
+
+        const _node* _n;
+
+        node_view(const _node* n) noexcept :
+            _n(n)
+        {
+
+        }
+
+    public:
+        node_view() noexcept :
+            _n(nullptr)
+        {
+
+        }
+
+        /// @brief Tell whether this view points at no node
+        bool is_null() const noexcept {
+            return _n == nullptr;
+        }
+
+        const_reference value() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(!is_null(), "persistent_tree", critical, "node view is null", exception::iterator::illegal_dereference_error);
+
+            return _n->value;
+        }
+
+        const_reference operator*() const CPPTOOLS_NOEXCEPT_RELEASE {
+            return value();
+        }
+
+        const_pointer operator->() const CPPTOOLS_NOEXCEPT_RELEASE {
+            return &value();
+        }
+
+        /// @brief Get the amount of children of the node
+        size_type child_count() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(!is_null(), "persistent_tree", critical, "node view is null", exception::iterator::illegal_dereference_error);
+
+            return _n->children.size();
+        }
+
+        /// @brief Get a view of a child of the node
+        node_view child(size_type index) const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(index < child_count(), "persistent_tree", critical, "index out of bounds", exception::parameter::invalid_value_error, "index", index);
+
+            return _n->children[index].get();
+        }
+
+        /// @brief Get the amount of nodes below the node, in O(1)
+        size_type descendant_count() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(!is_null(), "persistent_tree", critical, "node view is null", exception::iterator::illegal_dereference_error);
+
+            return _n->size - 1;
+        }
+
+        /// @brief Views are equal if they point at the same node, which is
+        /// the case of views of a subtree shared between versions
+        bool operator==(const node_view& other) const noexcept = default;
+    };
+
+    /// @brief Forward iterator implementing pre-order DFS traversal of a
+    /// version of the tree
+    class const_iterator {
+        friend class persistent_tree;
+
+    public:
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = const value_type&;
+        using pointer           = const value_type*;
+        using iterator_category = std::forward_iterator_tag;
+
+    private:
+        /// @brief Nodes yet to be visited, the current one at the back
+        /// @note Nodes have no parent pointers, so the traversal needs a stack
+        std::vector<const _node*> _pending;
+
+        explicit const_iterator(const _node* root) {
+            if (root != nullptr) {
+                _pending.push_back(root);
+            }
+        }
+
+    public:
+        const_iterator() = default;
+
+        const_iterator& operator++() CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(!_pending.empty(), "persistent_tree", critical, "cannot prefix-increment a past-the-end iterator", exception::iterator::incremented_past_end_error);
+
+            const _node* n = _pending.back();
+            _pending.pop_back();
+
+            for (auto it = n->children.rbegin(); it != n->children.rend(); ++it) {
+                _pending.push_back(it->get());
+            }
+
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+
+            return tmp;
+        }
+
+        reference operator*() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(!_pending.empty(), "persistent_tree", critical, "cannot dereference a past-the-end iterator", exception::iterator::illegal_dereference_error);
+
+            return _pending.back()->value;
+        }
+
+        pointer operator->() const CPPTOOLS_NOEXCEPT_RELEASE {
+            return &(**this);
+        }
+
+        /// @brief Get a view of the node currently being iterated over
+        node_view node() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(!_pending.empty(), "persistent_tree", critical, "cannot dereference a past-the-end iterator", exception::iterator::illegal_dereference_error);
+
+            return _pending.back();
+        }
+
+        bool operator==(const const_iterator& rhs) const noexcept {
+            // both iterators come from the same traversal: the current node
+            // and the depth of the stack identify the position in it
+            return (_pending.size() == rhs._pending.size())
+                && (_pending.empty() || _pending.back() == rhs._pending.back());
+        }
+    };
+
+    using iterator = const_iterator;
+
+    persistent_tree(allocator_type alloc = {}) :
+        _root(),
+        _alloc(std::move(alloc))
+    {
+
+    }
+
+    /// @param init Tree-like initializer list
+    persistent_tree(const initializer& init, allocator_type alloc = {}) :
+        persistent_tree(std::move(alloc))
+    {
+        _root = _make_from_init(init);
+    }
+
+    /// @brief Copy a version of the tree, in O(1). The copy shares all of
+    /// its nodes with the original until either of them is mutated.
+    persistent_tree(const persistent_tree& other) = default;
+    persistent_tree(persistent_tree&& other) noexcept = default;
+
+    persistent_tree& operator=(persistent_tree other) noexcept {
+        swap(*this, other);
+
+        return *this;
+    }
+
+    ~persistent_tree() = default;
+
+    friend void swap(persistent_tree& lhs, persistent_tree& rhs) noexcept {
+        using std::swap;
+        swap(lhs._root, rhs._root);
+        swap(lhs._alloc, rhs._alloc);
+    }
+
+    /// @brief Get the allocator instance for this tree
+    allocator_type get_allocator() const {
+        return _alloc;
+    }
+
+    /// @brief Take a snapshot of the current version of the tree, in O(1)
+    /// @return An immutable copy of the current version, which no mutation
+    /// of this tree will ever affect
+    persistent_tree snapshot() const noexcept {
+        return *this;
+    }
+
+    /// @brief Get a view of the root node, null if the tree is empty
+    node_view root() const noexcept {
+        return _root.get();
+    }
+
+    /// @brief Get a view of the node designated by a path
+    node_view at(const path& p) const CPPTOOLS_NOEXCEPT_RELEASE {
+        return _find(p);
+    }
+
+    /// @brief Construct a new node as the last child of another
+    /// @param parent Path to the parent node, must be empty if the tree is
+    /// empty, in which case the new node becomes its root
+    /// @param args Arguments to be forwarded to the constructor of the value
+    /// @return The path to the new node
+    template<typename... ArgTypes>
+    path emplace_node(const path& parent, ArgTypes&&... args) {
+        const size_type position = empty() ? 0 : _find(parent)->children.size();
+
+        return emplace_node_at(parent, position, std::forward<ArgTypes>(args)...);
+    }
+
+    /// @brief Construct a new node at some position among the children of
+    /// another
+    /// @param parent Path to the parent node, must be empty if the tree is
+    /// empty, in which case the new node becomes its root
+    /// @param position Position of the new node among the children of
+    /// \c parent, which must not be greater than their amount
+    /// @param args Arguments to be forwarded to the constructor of the value
+    /// @return The path to the new node
+    template<typename... ArgTypes>
+    path emplace_node_at(const path& parent, size_type position, ArgTypes&&... args) {
+        if (empty()) {
+            CPPTOOLS_DEBUG_ASSERT(parent.empty(), "persistent_tree", critical, "emplacement path must be empty if the tree is empty", exception::parameter::invalid_value_error, "parent", parent.size());
+
+            _root = _make_node(std::forward<ArgTypes>(args)...);
+            return {};
+        }
+
+        // construct first so that nothing is copied if construction throws
+        _node_ptr n = _make_node(std::forward<ArgTypes>(args)...);
+
+        _node* dest = _unshare_path(parent);
+        CPPTOOLS_DEBUG_ASSERT(position <= dest->children.size(), "persistent_tree", critical, "position out of bounds", exception::parameter::invalid_value_error, "position", position);
+
+        dest->children.insert(dest->children.begin() + position, std::move(n));
+        _resize_path(parent, 1);
+
+        path result;
+        result.reserve(parent.size() + 1);
+        result.assign(parent.begin(), parent.end());
+        result.push_back(position);
+
+        return result;
+    }
+
+    /// @brief Replace the value of a node
+    /// @param p Path to the node
+    /// @param value New value of the node
+    void assign(const path& p, T value) {
+        _unshare_path(p)->value = std::move(value);
+    }
+
+    /// @brief Mutate the value of a node in place
+    /// @param p Path to the node
+    /// @param f Callable to be invoked with a reference to the value
+    template<typename F>
+    void modify(const path& p, F&& f) {
+        std::forward<F>(f)(_unshare_path(p)->value);
+    }
+
+    /// @brief Erase a node and all of its descendants
+    /// @param p Path to the root of the subtree to erase, the empty path
+    /// clearing the tree
+    void erase_subtree(const path& p) {
+        if (p.empty()) {
+            clear();
+            return;
+        }
+
+        const path parent_path(p.begin(), p.end() - 1);
+        const auto erased_size = static_cast<difference_type>(_find(p)->size);
+
+        _node* parent = _unshare_path(parent_path);
+        parent->children.erase(parent->children.begin() + p.back());
+        _resize_path(parent_path, -erased_size);
+    }
+
+    /// @brief Get the amount of nodes in the tree, in O(1)
+    size_type size() const noexcept {
+        return empty() ? 0 : _root->size;
+    }
+
+    /// @brief Get whether the tree is empty
+    bool empty() const noexcept {
+        return _root == nullptr;
+    }
+
+    /// @brief Clear this version of the tree
+    void clear() {
+        _root.reset();
+    }
+
+    /// @brief Check whether this version of the tree and another have the
+    /// same structure and values
+    /// @note Subtrees shared by both versions are not visited.
+    bool operator==(const persistent_tree& other) const {
+        std::vector<std::pair<const _node*, const _node*>> pending;
+        pending.emplace_back(_root.get(), other._root.get());
+
+        while (!pending.empty()) {
+            auto [lhs, rhs] = pending.back();
+            pending.pop_back();
+
+            if (lhs == rhs) {
+                continue;
+            }
+
+            if (lhs == nullptr || rhs == nullptr
+             || lhs->size != rhs->size
+             || lhs->children.size() != rhs->children.size()
+             || !(lhs->value == rhs->value)) {
+                return false;
+            }
+
+            for (size_type i = 0; i < lhs->children.size(); ++i) {
+                pending.emplace_back(lhs->children[i].get(), rhs->children[i].get());
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief Get the begin iterator for a pre-order traversal of the tree
+    const_iterator begin() const {
+        return const_iterator(_root.get());
+    }
+
+    /// @brief Get the end iterator for a pre-order traversal of the tree
+    const_iterator end() const noexcept {
+        return const_iterator();
+    }
+
+    /// @copydoc persistent_tree::begin
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    /// @copydoc persistent_tree::end
+    const_iterator cend() const noexcept {
+        return end();
+    }
+};
+
+} // namespace tools
+
+#include <cpptools/_internal/undef_debug_macros.hpp>
+
+#endif//CPPTOOLS_CONTAINER_PERSISTENT_TREE_HPP
@@ -2,11 +2,21 @@
 #define CPPTOOLS_CONTAINER_TREE_HPP
 
 #include <algorithm>
+#include <concepts>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <span>
 #include <utility>
+#include <vector>
 
+#include "tree/flat.hpp"
+#include "tree/lca.hpp"
+#include "tree/parallel.hpp"
 #include "tree/traversal.hpp"
 #include "tree/unsafe_tree.hpp"
 
+#include <cpptools/exception/io_exception.hpp>
 #include <cpptools/utility/merge_strategy.hpp>
 
 #ifndef CPPTOOLS_DEBUG_TREE
@@ -19,6 +29,28 @@
 
 namespace tools {
 
+template<typename T>
+class tree;
+
+namespace detail {
+
+template<typename T>
+class tree_differ;
+
+} // namespace detail
+
+template<typename T, typename Map, typename Combine>
+auto parallel_reduce(const tree<T>& t, Map map, Combine combine);
+
+template<typename T, typename F>
+void parallel_for_each(tree<T>& t, F f);
+
+template<typename T, typename F>
+void parallel_for_each(const tree<T>& t, F f);
+
+template<typename T>
+void write_flat(const tree<T>& t, std::ostream& os);
+
 /// @brief An arbitrary tree. STL-compatible.
 /// @tparam T Type of values to be stored
 template<typename T>
@@ -105,10 +137,23 @@ public:
     {
     }
 
+    /// @copydoc base::no_parent
+    static constexpr size_type no_parent = base::no_parent;
+
+    /// @copydoc base::from_parent_array
+    static tree from_parent_array(std::span<const T> values, std::span<const size_type> parents) {
+        return tree(base::from_parent_array(values, parents));
+    }
+
+    /// @copydoc base::from_preorder
+    static tree from_preorder(std::span<const T> values, std::span<const size_type> child_counts) {
+        return tree(base::from_preorder(values, child_counts));
+    }
+
     /// @brief Copy assignment
     /// @param other Tree to copy-assign contents from
     tree& operator=(const tree& other) {
-        *this = tree(other);
+        base::operator=(other);
 
         return *this;
     }
@@ -162,6 +207,13 @@ public:
         };
     }
 
+    /// @copydoc base::adopt_subtree(node_t*, size_type, unsafe_tree&&)
+    node_handle_t adopt_subtree(const node_handle_t& destination, size_type position, tree other) {
+        return {
+            base::adopt_subtree(destination.ptr(), position, std::move(other))
+        };
+    }
+
     /// @copydoc base::root
     node_handle_t root() {
         return { base::root() };
@@ -202,6 +254,20 @@ public:
         base::erase_subtree(subtree_root.ptr());
     }
 
+    /// @copydoc base::remove_children
+    /// @note The predicate is invoked with a const handle to each child.
+    template<std::predicate<const const_node_handle_t&> Pred>
+    size_type remove_children(const node_handle_t& parent, Pred pred) {
+        return base::remove_children(parent.ptr(), [&pred](const node_t* child) {
+            return pred(const_node_handle_t{ child });
+        });
+    }
+
+    /// @copydoc base::erase_children
+    void erase_children(const node_handle_t& parent, size_type first, size_type last) {
+        base::erase_children(parent.ptr(), first, last);
+    }
+
     /// @copydoc base::emplace_node
     template<typename ...ArgTypes>
     node_handle_t emplace_node(const node_handle_t& where, ArgTypes&&... args) {
@@ -216,6 +282,54 @@ public:
         base::template merge_with_parent<merge_t>(n.ptr());
     }
 
+    /// @brief Scope within which node emplacements, erasures and moves are
+    /// applied to a tree in bulk, the tree being fixed up once when the scope
+    /// is committed or destroyed
+    /// @see base::begin_batch
+    class batch_scope {
+        tree* _tree;
+
+    public:
+        /// @param t Tree to mutate in bulk, which must outlive the scope
+        explicit batch_scope(tree& t) noexcept :
+            _tree(&t)
+        {
+            _tree->base::begin_batch();
+        }
+
+        batch_scope(const batch_scope& other) = delete;
+        batch_scope& operator=(const batch_scope& other) = delete;
+
+        /// @note Failing to commit from the destructor terminates the
+        /// program: call \c commit to handle allocation failures.
+        ~batch_scope() {
+            commit();
+        }
+
+        /// @brief Commit the mutations made within the scope, which ends it
+        /// @see base::commit_batch
+        void commit() {
+            if (_tree != nullptr) {
+                _tree->base::commit_batch();
+                _tree = nullptr;
+            }
+        }
+    };
+
+    /// @brief Open a scope within which node emplacements, erasures and moves
+    /// skip the upkeep of extremum nodes, subtree sizes and sibling indices,
+    /// which is done in a single pass when the scope ends
+    /// @note Within the scope, the tree and its nodes must not be inspected
+    /// nor mutated in any other way than through \c emplace_node,
+    /// \c erase_subtree and \c move_subtree.
+    /// @see base::begin_batch
+    [[nodiscard]] batch_scope batch() {
+        return batch_scope(*this);
+    }
+
+    /// @copydoc base::in_batch
+    using base::in_batch;
+
     /// @copydoc base::operator==
     bool operator==(const tree& other) const {
         return base::operator==(other);
@@ -242,6 +356,146 @@ public:
     using base::cbegin;
     /// @copydoc base::cend
     using base::cend;
+    /// @copydoc base::enable_ancestor_index
+    using base::enable_ancestor_index;
+    /// @copydoc base::disable_ancestor_index
+    using base::disable_ancestor_index;
+    /// @copydoc base::has_ancestor_index
+    using base::has_ancestor_index;
+    /// @copydoc base::ancestor_index_up_to_date
+    using base::ancestor_index_up_to_date;
+    /// @copydoc base::reindex
+    using base::reindex;
+    /// @copydoc base::enable_subtree_sizes
+    using base::enable_subtree_sizes;
+    /// @copydoc base::disable_subtree_sizes
+    using base::disable_subtree_sizes;
+    /// @copydoc base::has_subtree_sizes
+    using base::has_subtree_sizes;
+
+    /// @copydoc base::descendant_count
+    size_type descendant_count(const const_node_handle_t& n) const {
+        return base::descendant_count(n.ptr());
+    }
+
+    /// @copydoc base::nth_pre_order
+    node_handle_t nth_pre_order(size_type index) {
+        return { base::nth_pre_order(index) };
+    }
+
+    /// @copydoc base::nth_pre_order
+    const_node_handle_t nth_pre_order(size_type index) const {
+        return { base::nth_pre_order(index) };
+    }
+
+    /// @copydoc base::pre_order_index
+    size_type pre_order_index(const const_node_handle_t& n) const {
+        return base::pre_order_index(n.ptr());
+    }
+
+    /// @copydoc base::enable_hashing
+    using base::enable_hashing;
+    /// @copydoc base::disable_hashing
+    using base::disable_hashing;
+    /// @copydoc base::has_hashing
+    using base::has_hashing;
+    /// @copydoc base::rehash
+    using base::rehash;
+    /// @copydoc base::hashes_up_to_date
+    using base::hashes_up_to_date;
+
+    /// @copydoc base::touch
+    void touch(const const_node_handle_t& n) {
+        base::touch(n.ptr());
+    }
+
+    /// @copydoc base::subtree_hash
+    std::size_t subtree_hash(const const_node_handle_t& n) const requires hashable<T> {
+        return base::subtree_hash(n.ptr());
+    }
+
+    /// @copydoc base::differing_subtrees
+    std::vector<std::pair<const_node_handle_t, const_node_handle_t>> differing_subtrees(const tree& other) const requires hashable<T> {
+        auto pairs = base::differing_subtrees(other);
+
+        std::vector<std::pair<const_node_handle_t, const_node_handle_t>> result;
+        result.reserve(pairs.size());
+        for (const auto& [lhs, rhs] : pairs) {
+            result.emplace_back(const_node_handle_t{ lhs }, const_node_handle_t{ rhs });
+        }
+
+        return result;
+    }
+
+    /// @copydoc base::has_parent
+    bool has_parent(const const_node_handle_t& n, const const_node_handle_t& ancestor) const {
+        return base::has_parent(n.ptr(), ancestor.ptr());
+    }
+
+    /// @brief Tell whether a node is a strict ancestor of another
+    /// @param ancestor Node which should be an ancestor to \c n
+    /// @param n Node whose ancestry to check
+    /// @note Runs in constant time if the ancestor index is enabled and up to
+    /// date, see \c reindex. Otherwise, walks up from \c n.
+    bool is_parent_of(const const_node_handle_t& ancestor, const const_node_handle_t& n) const {
+        return base::has_parent(n.ptr(), ancestor.ptr());
+    }
+
+    /// @brief Lowest common ancestor and path queries over a tree, answered
+    /// in constant time after a linearithmic build
+    /// @note The index must be rebuilt once the tree has been mutated, which
+    /// \c stale() tells.
+    class lca_index {
+        detail::lca_table<T> _table;
+
+    public:
+        /// @param t Tree to answer queries about, which must outlive the index
+        explicit lca_index(const tree& t) :
+            _table(static_cast<const base&>(t))
+        {
+        }
+
+        /// @copydoc detail::lca_table::stale
+        bool stale() const {
+            return _table.stale();
+        }
+
+        /// @brief Get the lowest common ancestor of two nodes
+        const_node_handle_t lca(const const_node_handle_t& lhs, const const_node_handle_t& rhs) const {
+            return { _table.lca(lhs.ptr(), rhs.ptr()) };
+        }
+
+        /// @brief Get the lowest common ancestor of many pairs of nodes
+        /// @param queries Pairs of nodes to find the lowest common ancestor of
+        /// @return The lowest common ancestor of each pair, in order
+        std::vector<const_node_handle_t> lca(std::span<const std::pair<const_node_handle_t, const_node_handle_t>> queries) const {
+            std::vector<const_node_handle_t> result;
+            result.reserve(queries.size());
+
+            for (const auto& [lhs, rhs] : queries) {
+                result.emplace_back(_table.lca(lhs.ptr(), rhs.ptr()));
+            }
+
+            return result;
+        }
+
+        /// @copydoc detail::lca_table::depth
+        size_type depth(const const_node_handle_t& n) const {
+            return _table.depth(n.ptr());
+        }
+
+        /// @copydoc detail::lca_table::distance
+        size_type distance(const const_node_handle_t& lhs, const const_node_handle_t& rhs) const {
+            return _table.distance(lhs.ptr(), rhs.ptr());
+        }
+
+        /// @copydoc detail::lca_table::path
+        std::vector<const_node_handle_t> path(const const_node_handle_t& from, const const_node_handle_t& to) const {
+            auto nodes = _table.path(from.ptr(), to.ptr());
+
+            return { nodes.begin(), nodes.end() };
+        }
+    };
 
     /// @brief Get a proxy range-like object which implements DFS const
     /// traversal of the tree. To be used with range-based \c for loops.
@@ -257,6 +511,30 @@ public:
         return dfs<O>(static_cast<base&>(t));
     }
 
+    /// @brief Get a proxy range-like object which implements BFS const
+    /// traversal of the tree. To be used with range-based \c for loops.
+    friend detail::bfs_proxy<T, true> bfs(const tree<T>& t) {
+        return bfs(static_cast<const base&>(t));
+    }
+
+    /// @brief Get a proxy range-like object which implements BFS traversal of
+    /// the tree. To be used with range-based \c for loops.
+    friend detail::bfs_proxy<T, false> bfs(tree<T>& t) {
+        return bfs(static_cast<base&>(t));
+    }
+
+    /// @brief Get a proxy range-like object which yields the const nodes of
+    /// the tree one depth level at a time, each as a contiguous span.
+    friend detail::levels_proxy<T, true> levels(const tree<T>& t) {
+        return levels(static_cast<const base&>(t));
+    }
+
+    /// @brief Get a proxy range-like object which yields the nodes of the
+    /// tree one depth level at a time, each as a contiguous span.
+    friend detail::levels_proxy<T, false> levels(tree<T>& t) {
+        return levels(static_cast<base&>(t));
+    }
+
     /// @brief Get a proxy range-like object which implements reverse DFS const
     /// traversal of the tree. To be used with range-based \c for loops.
     template<traversal::order O>
@@ -270,8 +548,84 @@ public:
     friend detail::reverse_dfs_proxy<T, O, false> reverse_dfs(tree<T>& t) {
         return reverse_dfs<O>(static_cast<base&>(t));
     }
+
+    template<typename U, typename Map, typename Combine>
+    friend auto parallel_reduce(const tree<U>& t, Map map, Combine combine);
+
+    template<typename U, typename F>
+    friend void parallel_for_each(tree<U>& t, F f);
+
+    template<typename U, typename F>
+    friend void parallel_for_each(const tree<U>& t, F f);
+
+    template<typename U>
+    friend void write_flat(const tree<U>& t, std::ostream& os);
+
+    template<typename U>
+    friend class detail::tree_differ;
 };
 
+/// @brief Reduce the values of a tree, fanning the work out over its
+/// subtrees to a thread pool shared by all parallel tree algorithms.
+/// @param t Tree whose values to reduce
+/// @param map Function mapping a value to a partial result
+/// @param combine Associative function combining two partial results
+/// @return The combination of the mapped values of all nodes, in pre-order,
+/// or a value-initialized result if the tree is empty. The result does not
+/// depend on thread scheduling.
+/// @exception tools::exception::internal::precondition_failure_error The tree
+/// is empty and the result type is not default-constructible.
+template<typename T, typename Map, typename Combine>
+auto parallel_reduce(const tree<T>& t, Map map, Combine combine) {
+    return detail::parallel_reduce(static_cast<const detail::unsafe_tree<T>&>(t), std::move(map), std::move(combine));
+}
+
+/// @brief Apply a function to all values of a tree, fanning the work out
+/// over its subtrees to a thread pool shared by all parallel tree algorithms.
+/// @param t Tree whose values to process
+/// @param f Function to apply to each value, in unspecified order
+template<typename T, typename F>
+void parallel_for_each(tree<T>& t, F f) {
+    detail::parallel_for_each<T>(static_cast<detail::unsafe_tree<T>&>(t), std::move(f));
+}
+
+/// @copydoc parallel_for_each
+template<typename T, typename F>
+void parallel_for_each(const tree<T>& t, F f) {
+    detail::parallel_for_each<T>(static_cast<const detail::unsafe_tree<T>&>(t), std::move(f));
+}
+
+/// @brief Write a tree to a stream in a flat format, which can be viewed
+/// without deserialization through \c flat_tree_view
+/// @param t Tree to write, whose values must be trivially copyable
+/// @param os Stream to write to, which should be opened in binary mode
+/// @exception exception::io::invalid_output_stream_error if writing to the
+/// stream failed
+template<typename T>
+void write_flat(const tree<T>& t, std::ostream& os) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trees of trivially copyable values can be written in flat format");
+
+    detail::write_flat(static_cast<const detail::unsafe_tree<T>&>(t), os);
+}
+
+/// @brief Write a tree to a file in a flat format, which can be mapped back
+/// through \c flat_tree_view::open
+/// @param t Tree to write, whose values must be trivially copyable
+/// @param path Path to the file to write, which is overwritten if it exists
+/// @exception exception::io::access_denied_error if the file could not be
+/// opened
+/// @exception exception::io::invalid_output_stream_error if writing to the
+/// file failed
+template<typename T>
+void save_flat(const tree<T>& t, const std::filesystem::path& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        CPPTOOLS_THROW(exception::io::access_denied_error, path);
+    }
+
+    write_flat(t, file);
+}
+
 } // namespace tools
 
 #include <cpptools/_internal/undef_debug_macros.hpp>
@@ -282,7 +636,6 @@ public:
 
 // - do likeliness annotations really make a difference?
 // - custom allocators (and then scary iterators)
-// - store values contiguously instead of within a node map. std::hive comes to mind
 
 // TODO: Ctrl+F TODO
 
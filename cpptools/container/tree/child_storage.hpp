@@ -0,0 +1,256 @@
+#ifndef CPPTOOLS_CONTAINER_TREE_CHILD_STORAGE_HPP
+#define CPPTOOLS_CONTAINER_TREE_CHILD_STORAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+
+#ifndef CPPTOOLS_DEBUG_CHILD_STORAGE
+# define CPPTOOLS_DEBUG_CHILD_STORAGE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
+#endif
+
+#define CPPTOOLS_I_HAVE_INCLUDED_UNDEF_DEBUG_MACROS_LATER_ON_IN_THIS_FILE
+#define CPPTOOLS_LOCAL_DEBUG_MACRO CPPTOOLS_DEBUG_CHILD_STORAGE
+#include <cpptools/_internal/debug_macros.hpp>
+
+namespace tools::detail {
+
+/// @brief Sequence of pointers to the children of a node. Up to N pointers
+/// are stored inline, more spill over to a heap buffer.
+/// @tparam P Type of pointers to be stored
+/// @tparam N Amount of pointers which can be stored inline
+/// @tparam A Allocator type for the heap buffer
+/// @note Counts are stored on 32 bits to keep the storage compact: growing
+/// past 2^32 - 1 elements throws.
+/// @note Enable debug assertions with #define CPPTOOLS_DEBUG_CHILD_STORAGE 1
+template<typename P, std::size_t N, typename A = std::allocator<P>>
+class child_storage {
+    static_assert(std::is_trivially_copyable_v<P>, "child storage elements are copied bytewise");
+    static_assert(N > 0, "child storage must have inline capacity");
+
+    using _al_traits = std::allocator_traits<A>;
+    using _count_t   = std::uint32_t;
+
+public:
+    using value_type      = P;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = value_type*;
+    using const_pointer   = const value_type*;
+    using iterator        = pointer;
+    using const_iterator  = const_pointer;
+    using allocator_type  = A;
+
+    static constexpr size_type inline_capacity = N;
+
+private:
+    union {
+        value_type _inline[N];
+        pointer _heap;
+    };
+
+    _count_t _size;
+    _count_t _capacity;
+
+    [[no_unique_address]] allocator_type _alloc;
+
+    bool _is_inline() const noexcept {
+        return _capacity == N;
+    }
+
+    /// @brief Move the contents to a heap buffer able to hold at least some
+    /// amount of elements, without changing the size
+    /// @exception tools::exception::parameter::invalid_value_error The
+    /// capacity does not fit in a count.
+    void _grow(size_type min_capacity) {
+        constexpr size_type max_capacity = std::numeric_limits<_count_t>::max();
+        if (min_capacity > max_capacity) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "min_capacity", min_capacity).with_message("too many children");
+        }
+
+        const size_type new_capacity = std::clamp<size_type>(2 * size_type{ _capacity }, min_capacity, max_capacity);
+        pointer buffer = _al_traits::allocate(_alloc, new_capacity);
+        std::memcpy(buffer, data(), _size * sizeof(value_type));
+
+        if (!_is_inline()) {
+            _al_traits::deallocate(_alloc, _heap, _capacity);
+        }
+
+        _heap = buffer;
+        _capacity = static_cast<_count_t>(new_capacity);
+    }
+
+    /// @brief Open a gap of some size at some position, shifting elements
+    /// right of it
+    /// @return The start of the gap
+    pointer _open_gap(size_type index, size_type count) {
+        if (_size + count > _capacity) {
+            _grow(_size + count);
+        }
+
+        pointer gap = data() + index;
+        std::memmove(gap + count, gap, (_size - index) * sizeof(value_type));
+        _size += static_cast<_count_t>(count);
+
+        return gap;
+    }
+
+public:
+    child_storage(const allocator_type& alloc = {}) noexcept :
+        _size(0),
+        _capacity(N),
+        _alloc(alloc)
+    {
+
+    }
+
+    child_storage(const child_storage& other) = delete;
+    child_storage& operator=(const child_storage& other) = delete;
+
+    ~child_storage() {
+        if (!_is_inline()) {
+            _al_traits::deallocate(_alloc, _heap, _capacity);
+        }
+    }
+
+    pointer data() noexcept {
+        return _is_inline() ? _inline : _heap;
+    }
+
+    const_pointer data() const noexcept {
+        return _is_inline() ? _inline : _heap;
+    }
+
+    size_type size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    size_type capacity() const noexcept {
+        return _capacity;
+    }
+
+    iterator begin() noexcept {
+        return data();
+    }
+
+    iterator end() noexcept {
+        return data() + _size;
+    }
+
+    const_iterator begin() const noexcept {
+        return data();
+    }
+
+    const_iterator end() const noexcept {
+        return data() + _size;
+    }
+
+    reference operator[](size_type index) noexcept {
+        return data()[index];
+    }
+
+    const_reference operator[](size_type index) const noexcept {
+        return data()[index];
+    }
+
+    reference front() noexcept {
+        return data()[0];
+    }
+
+    const_reference front() const noexcept {
+        return data()[0];
+    }
+
+    reference back() noexcept {
+        return data()[_size - 1];
+    }
+
+    const_reference back() const noexcept {
+        return data()[_size - 1];
+    }
+
+    /// @brief Get a view of the elements
+    std::span<const value_type> span() const noexcept {
+        return { data(), _size };
+    }
+
+    /// @brief Make room for some amount of elements, spilling to the heap if
+    /// that amount does not fit inline
+    void reserve(size_type capacity) {
+        if (capacity > _capacity) {
+            _grow(capacity);
+        }
+    }
+
+    void push_back(value_type value) {
+        if (_size == _capacity) {
+            _grow(_size + 1);
+        }
+
+        data()[_size++] = value;
+    }
+
+    /// @brief Insert an element before some position
+    /// @return An iterator to the inserted element
+    iterator insert(const_iterator pos, value_type value) {
+        const size_type index = static_cast<size_type>(pos - begin());
+        pointer gap = _open_gap(index, 1);
+        *gap = value;
+
+        return gap;
+    }
+
+    /// @brief Insert a range of elements before some position
+    /// @return An iterator to the first inserted element
+    template<std::forward_iterator It>
+    iterator insert(const_iterator pos, It first, It last) {
+        const size_type index = static_cast<size_type>(pos - begin());
+        const auto count = static_cast<size_type>(std::distance(first, last));
+        pointer gap = _open_gap(index, count);
+        std::copy(first, last, gap);
+
+        return gap;
+    }
+
+    /// @brief Remove an element
+    /// @return An iterator to the element following the removed one
+    iterator erase(const_iterator pos) noexcept {
+        return erase(pos, pos + 1);
+    }
+
+    /// @brief Remove a range of elements
+    /// @return An iterator to the element following the removed ones
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        pointer dest = begin() + (first - begin());
+        std::memmove(dest, last, static_cast<size_type>(end() - last) * sizeof(value_type));
+        _size -= static_cast<_count_t>(last - first);
+
+        return dest;
+    }
+
+    /// @brief Remove all elements, keeping the storage
+    void clear() noexcept {
+        _size = 0;
+    }
+};
+
+} // namespace tools::detail
+
+#include <cpptools/_internal/undef_debug_macros.hpp>
+
+#endif//CPPTOOLS_CONTAINER_TREE_CHILD_STORAGE_HPP
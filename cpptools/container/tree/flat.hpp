@@ -0,0 +1,333 @@
+#ifndef CPPTOOLS_CONTAINER_TREE_FLAT_HPP
+#define CPPTOOLS_CONTAINER_TREE_FLAT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/io_exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/utility/mapped_file.hpp>
+
+#include "traversal.hpp"
+#include "unsafe_tree.hpp"
+
+#ifndef CPPTOOLS_DEBUG_FLAT_TREE
+# define CPPTOOLS_DEBUG_FLAT_TREE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
+#endif
+
+#define CPPTOOLS_I_HAVE_INCLUDED_UNDEF_DEBUG_MACROS_LATER_ON_IN_THIS_FILE
+#define CPPTOOLS_LOCAL_DEBUG_MACRO CPPTOOLS_DEBUG_FLAT_TREE
+#include <cpptools/_internal/debug_macros.hpp>
+
+namespace tools {
+
+namespace detail {
+
+/// @brief Header of a tree serialized in flat format. The header is followed
+/// by the values of all nodes in pre-order, then by the size of the subtree of
+/// each node in the same order. Each array is aligned for its element type.
+/// @note Everything is stored in the byte order of the machine which wrote
+/// the tree.
+struct flat_tree_header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order_mark;
+    std::uint64_t value_size;
+    std::uint64_t value_alignment;
+    std::uint64_t node_count;
+};
+
+inline constexpr char          flat_tree_magic[8]        = { 'C', 'P', 'P', 'T', 'R', 'E', 'E', '\0' };
+inline constexpr std::uint32_t flat_tree_version         = 1;
+inline constexpr std::uint32_t flat_tree_byte_order_mark = 0x01020304;
+
+/// @brief Offsets of the arrays of a flat tree, relative to the start of its
+/// header
+template<typename T>
+struct flat_tree_layout {
+    std::size_t values_offset;
+    std::size_t sizes_offset;
+    std::size_t total_size;
+
+    static constexpr std::size_t align_up(std::size_t offset, std::size_t alignment) noexcept {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    constexpr explicit flat_tree_layout(std::size_t node_count) noexcept :
+        values_offset(align_up(sizeof(flat_tree_header), alignof(T))),
+        sizes_offset(align_up(values_offset + node_count * sizeof(T), alignof(std::uint64_t))),
+        total_size(sizes_offset + node_count * sizeof(std::uint64_t))
+    {
+    }
+};
+
+/// @brief Write a tree to a stream in flat format
+/// @param t Tree to write
+/// @param os Stream to write to, which should be opened in binary mode
+/// @exception exception::io::invalid_output_stream_error if writing to the
+/// stream failed
+template<typename T>
+void write_flat(const unsafe_tree<T>& t, std::ostream& os) {
+    using node_t = typename unsafe_tree<T>::node_t;
+
+    const flat_tree_layout<T> layout(t.size());
+
+    flat_tree_header header = {};
+    std::copy(std::begin(flat_tree_magic), std::end(flat_tree_magic), header.magic);
+    header.version         = flat_tree_version;
+    header.byte_order_mark = flat_tree_byte_order_mark;
+    header.value_size      = sizeof(T);
+    header.value_alignment = alignof(T);
+    header.node_count      = t.size();
+
+    std::size_t written = sizeof(header);
+    auto pad_to = [&](std::size_t offset) {
+        for (; written < offset; ++written) {
+            os.put('\0');
+        }
+    };
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pad_to(layout.values_offset);
+
+    // subtree sizes are only known once a subtree was fully visited, write
+    // them after all values
+    std::vector<std::uint64_t> sizes(t.size());
+    std::vector<std::size_t> open_ranks;
+
+    std::size_t rank = 0;
+    const node_t* root = t.root();
+    const node_t* n = root;
+    while (n != nullptr) {
+        os.write(reinterpret_cast<const char*>(&n->value()), sizeof(T));
+        open_ranks.push_back(rank++);
+
+        if (n->child_count() != 0) {
+            n = n->child(0);
+            continue;
+        }
+
+        // close the leaf, then every ancestor it was the last node of
+        while (true) {
+            const std::size_t closed = open_ranks.back();
+            open_ranks.pop_back();
+            sizes[closed] = rank - closed;
+
+            if (n == root) {
+                n = nullptr;
+                break;
+            }
+
+            if (!n->is_rightmost_sibling()) {
+                n = n->right_sibling();
+                break;
+            }
+
+            n = n->parent();
+        }
+    }
+    written += t.size() * sizeof(T);
+
+    pad_to(layout.sizes_offset);
+    os.write(reinterpret_cast<const char*>(sizes.data()), static_cast<std::streamsize>(sizes.size() * sizeof(std::uint64_t)));
+
+    if (!os) {
+        CPPTOOLS_THROW(exception::io::invalid_output_stream_error, std::string("flat tree output stream"));
+    }
+}
+
+} // namespace detail
+
+/// @brief Read-only view over a tree serialized in flat format, either in a
+/// memory buffer or in a memory-mapped file. Nodes are identified by their
+/// index in a pre-order traversal of the tree.
+/// @tparam T Type of values held by the tree
+/// @note Values are never copied out of the underlying bytes.
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+class flat_tree_view {
+public:
+    using value_type      = T;
+    using const_reference = const value_type&;
+    using size_type       = std::size_t;
+    using const_iterator  = typename std::span<const T>::iterator;
+    using iterator        = const_iterator;
+
+    /// @brief Index used to signify the absence of a node
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+private:
+    /// @brief Mapping holding the bytes of the tree, if it was opened from a
+    /// file
+    std::shared_ptr<const mapped_file> _file;
+
+    /// @brief Values of the nodes, in pre-order
+    std::span<const T> _values;
+
+    /// @brief Subtree size of the nodes, in pre-order
+    std::span<const std::uint64_t> _sizes;
+
+    /// @brief Check that a buffer holds a tree in flat format and point into it
+    /// @param bytes Buffer holding the tree
+    /// @param name Name of the buffer, for error reporting
+    void _bind(std::span<const std::byte> bytes, std::string_view name) {
+        using namespace detail;
+
+        auto invalid = [&](const char* reason) {
+            CPPTOOLS_THROW(exception::io::invalid_input_stream_error, std::string(name)).with_message(reason);
+        };
+
+        if (bytes.empty()) {
+            return;
+        }
+
+        flat_tree_header header;
+        if (bytes.size() < sizeof(header)) {
+            invalid("buffer too small to hold a flat tree header");
+        }
+        std::copy_n(bytes.data(), sizeof(header), reinterpret_cast<std::byte*>(&header));
+
+        if (!std::equal(std::begin(flat_tree_magic), std::end(flat_tree_magic), header.magic)) {
+            invalid("buffer does not hold a flat tree");
+        }
+        if (header.version != flat_tree_version) {
+            invalid("unsupported flat tree version");
+        }
+        if (header.byte_order_mark != flat_tree_byte_order_mark) {
+            invalid("flat tree was written with a different byte order");
+        }
+        if (header.value_size != sizeof(T) || header.value_alignment != alignof(T)) {
+            invalid("flat tree holds values of a different type");
+        }
+        if (reinterpret_cast<std::uintptr_t>(bytes.data()) % std::max(alignof(T), alignof(std::uint64_t)) != 0) {
+            invalid("buffer is not suitably aligned");
+        }
+
+        // guard the size computations of the layout against overflow
+        if (header.node_count > bytes.size() / (sizeof(T) + sizeof(std::uint64_t))) {
+            invalid("buffer too small for the node count it advertises");
+        }
+
+        const auto node_count = static_cast<size_type>(header.node_count);
+        const flat_tree_layout<T> layout(node_count);
+        if (bytes.size() < layout.total_size) {
+            invalid("buffer too small for the node count it advertises");
+        }
+
+        _values = { reinterpret_cast<const T*>(bytes.data() + layout.values_offset), node_count };
+        _sizes  = { reinterpret_cast<const std::uint64_t*>(bytes.data() + layout.sizes_offset), node_count };
+    }
+
+public:
+    /// @brief Construct a view over an empty tree
+    flat_tree_view() noexcept = default;
+
+    /// @brief Construct a view over a tree in flat format held in a buffer
+    /// @param bytes Buffer holding the tree, which must outlive the view and
+    /// be aligned for both \c T and 64-bit integers
+    /// @exception exception::io::invalid_input_stream_error if the buffer does
+    /// not hold a tree of \c T in flat format
+    explicit flat_tree_view(std::span<const std::byte> bytes) {
+        _bind(bytes, "flat tree buffer");
+    }
+
+    /// @brief Map a file holding a tree in flat format and view the tree in it
+    /// @param path Path to the file to map
+    /// @return A view which keeps the file mapped for as long as it or any of
+    /// its copies lives
+    /// @exception exception::io::file_not_found_error if the file does not
+    /// exist
+    /// @exception exception::io::access_denied_error if the file could not be
+    /// mapped
+    /// @exception exception::io::invalid_input_stream_error if the file does
+    /// not hold a tree of \c T in flat format
+    static flat_tree_view open(const std::filesystem::path& path) {
+        flat_tree_view view;
+        view._file = std::make_shared<const mapped_file>(path);
+        view._bind(view._file->bytes(), path.string());
+
+        return view;
+    }
+
+    /// @brief Get the amount of nodes in the tree
+    size_type size() const noexcept {
+        return _values.size();
+    }
+
+    /// @brief Get whether the tree is empty
+    bool empty() const noexcept {
+        return _values.empty();
+    }
+
+    /// @brief Get the values of all nodes, in pre-order
+    std::span<const T> values() const noexcept {
+        return _values;
+    }
+
+    /// @brief Get the value of a node
+    const_reference value(size_type n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < size(), "flat_tree_view", critical, "node out of bounds", exception::parameter::invalid_value_error, "n", n);
+
+        return _values[n];
+    }
+
+    /// @brief Get the amount of nodes below a node
+    size_type descendant_count(size_type n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < size(), "flat_tree_view", critical, "node out of bounds", exception::parameter::invalid_value_error, "n", n);
+
+        return static_cast<size_type>(_sizes[n]) - 1;
+    }
+
+    /// @brief Get the first child of a node
+    /// @return The index of the first child of \c n, or \c npos if it has no
+    /// children
+    size_type first_child(size_type n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        return (descendant_count(n) != 0) ? n + 1 : npos;
+    }
+
+    /// @brief Get the index following the subtree of a node, which is that of
+    /// its right sibling if it has one
+    /// @note Children of a node \c p are enumerated by starting from
+    /// \c first_child(p) and calling this function until it reaches
+    /// \c subtree_end(p).
+    size_type subtree_end(size_type n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(n < size(), "flat_tree_view", critical, "node out of bounds", exception::parameter::invalid_value_error, "n", n);
+
+        return n + static_cast<size_type>(_sizes[n]);
+    }
+
+    /// @brief Get the begin iterator for a pre-order traversal of the tree
+    const_iterator begin() const noexcept {
+        return _values.begin();
+    }
+
+    /// @brief Get the end iterator for a pre-order traversal of the tree
+    const_iterator end() const noexcept {
+        return _values.end();
+    }
+
+    /// @brief Get a range which implements pre-order DFS traversal of the
+    /// tree. Nodes are laid out in pre-order, so this is a plain span.
+    template<traversal::order O>
+        requires (O == traversal::pre_order)
+    friend std::span<const T> dfs(const flat_tree_view& v) {
+        return v._values;
+    }
+};
+
+} // namespace tools
+
+#include <cpptools/_internal/undef_debug_macros.hpp>
+
+#endif//CPPTOOLS_CONTAINER_TREE_FLAT_HPP
@@ -0,0 +1,215 @@
+#ifndef CPPTOOLS_CONTAINER_TREE_LCA_HPP
+#define CPPTOOLS_CONTAINER_TREE_LCA_HPP
+
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <cpptools/exception/parameter_exception.hpp>
+
+#include "unsafe_tree.hpp"
+
+#ifndef CPPTOOLS_DEBUG_LCA
+# define CPPTOOLS_DEBUG_LCA CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
+#endif
+
+#define CPPTOOLS_I_HAVE_INCLUDED_UNDEF_DEBUG_MACROS_LATER_ON_IN_THIS_FILE
+#define CPPTOOLS_LOCAL_DEBUG_MACRO CPPTOOLS_DEBUG_LCA
+#include <cpptools/_internal/debug_macros.hpp>
+
+namespace tools::detail {
+
+/// @brief Lowest common ancestor queries over a tree which is not mutated
+/// in-between queries
+/// @note Nodes are ranked in pre-order. For two nodes of ranks \c u < \c v,
+/// the shallowest node ranked in \c (u, v] is a child of their lowest common
+/// ancestor, which a sparse table finds in constant time.
+template<typename T, typename A = std::allocator<T>>
+class lca_table {
+public:
+    using tree_t    = unsafe_tree<T, A>;
+    using node_t    = typename tree_t::node_t;
+    using size_type = typename tree_t::size_type;
+
+private:
+    /// @brief Tree the table was built from
+    const tree_t* _tree;
+
+    /// @brief Revision of the tree at the time the table was built
+    size_type _revision;
+
+    /// @brief Pre-order rank of the nodes, indexed by pool slot
+    std::vector<size_type> _rank;
+
+    /// @brief Nodes, indexed by pre-order rank
+    std::vector<const node_t*> _nodes;
+
+    /// @brief Depth of the nodes, indexed by pre-order rank
+    std::vector<size_type> _depth;
+
+    /// @brief Rank of the parent of the nodes, indexed by pre-order rank
+    std::vector<size_type> _parent;
+
+    /// @brief Row \c k holds, for each rank \c i, the rank of the shallowest
+    /// node among ranks \c [i, i + 2^k)
+    std::vector<size_type> _table;
+
+    /// @brief Get the shallowest of two nodes, given by rank
+    size_type _shallowest(size_type lhs, size_type rhs) const noexcept {
+        return _depth[rhs] < _depth[lhs] ? rhs : lhs;
+    }
+
+    /// @brief Get the rank of the shallowest node ranked in [first, last]
+    size_type _range_min(size_type first, size_type last) const noexcept {
+        const size_type n   = _nodes.size();
+        const size_type row = std::bit_width(last - first + 1) - 1;
+
+        return _shallowest(
+            _table[row * n + first],
+            _table[row * n + last + 1 - (size_type{1} << row)]
+        );
+    }
+
+    /// @brief Get the rank of the lowest common ancestor of two nodes, given
+    /// by rank
+    size_type _lca(size_type u, size_type v) const noexcept {
+        if (u == v) {
+            return u;
+        }
+
+        if (v < u) {
+            std::swap(u, v);
+        }
+
+        return _parent[_range_min(u + 1, v)];
+    }
+
+    size_type _rank_of(const node_t* n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(not_null(n), "lca_table", critical, "null node", exception::parameter::null_parameter_error, "n");
+
+        return _rank[tree_t::slot_of(n)];
+    }
+
+public:
+    /// @param t Tree to answer queries about. It must outlive the table and
+    /// not be mutated while queries are made.
+    explicit lca_table(const tree_t& t) :
+        _tree(&t),
+        _revision(t.revision()),
+        _rank(t.slot_count()),
+        _nodes(),
+        _depth(),
+        _parent(),
+        _table()
+    {
+        const size_type n = t.size();
+        _nodes.reserve(n);
+        _depth.reserve(n);
+        _parent.reserve(n);
+
+        // pre-order walk, keeping track of the rank of the current parent
+        size_type parent = 0;
+        size_type depth  = 0;
+        for (const node_t* node = t.root(); node != nullptr; ) {
+            const size_type rank = _nodes.size();
+            _rank[tree_t::slot_of(node)] = rank;
+            _nodes.push_back(node);
+            _depth.push_back(depth);
+            _parent.push_back(depth == 0 ? rank : parent);
+
+            if (node->child_count() != 0) {
+                parent = rank;
+                ++depth;
+                node = node->child(0);
+                continue;
+            }
+
+            while (node != t.root() && node->is_rightmost_sibling()) {
+                node = node->parent();
+                --depth;
+            }
+
+            if (node == t.root()) {
+                break;
+            }
+
+            node   = node->right_sibling();
+            parent = _rank[tree_t::slot_of(node->parent())];
+        }
+
+        // sparse table, one row per power of two
+        const size_type rows = n == 0 ? 0 : std::bit_width(n);
+        _table.resize(rows * n);
+
+        for (size_type i = 0; i < n; ++i) {
+            _table[i] = i;
+        }
+
+        for (size_type row = 1; row < rows; ++row) {
+            const size_type half = size_type{1} << (row - 1);
+            const size_type* prev = _table.data() + (row - 1) * n;
+            size_type* curr = _table.data() + row * n;
+
+            for (size_type i = 0; i + 2 * half <= n; ++i) {
+                curr[i] = _shallowest(prev[i], prev[i + half]);
+            }
+        }
+    }
+
+    /// @brief Tell whether the tree was mutated since the table was built
+    bool stale() const {
+        return _tree->revision() != _revision;
+    }
+
+    /// @brief Get the lowest common ancestor of two nodes of the tree
+    const node_t* lca(const node_t* lhs, const node_t* rhs) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(!stale(), "lca_table", critical, "tree was mutated since the table was built", exception::parameter::invalid_value_error, "lhs", lhs);
+
+        return _nodes[_lca(_rank_of(lhs), _rank_of(rhs))];
+    }
+
+    /// @brief Get the depth of a node, the root being at depth 0
+    size_type depth(const node_t* n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        return _depth[_rank_of(n)];
+    }
+
+    /// @brief Get the amount of edges on the path between two nodes
+    size_type distance(const node_t* lhs, const node_t* rhs) const CPPTOOLS_NOEXCEPT_RELEASE {
+        const size_type u = _rank_of(lhs);
+        const size_type v = _rank_of(rhs);
+
+        return _depth[u] + _depth[v] - 2 * _depth[_lca(u, v)];
+    }
+
+    /// @brief Get the nodes on the path between two nodes, both included
+    /// @return The nodes, from \c from up to the lowest common ancestor then
+    /// down to \c to
+    std::vector<const node_t*> path(const node_t* from, const node_t* to) const {
+        size_type u = _rank_of(from);
+        size_type v = _rank_of(to);
+        const size_type top = _lca(u, v);
+
+        std::vector<const node_t*> result(_depth[u] + _depth[v] - 2 * _depth[top] + 1);
+
+        // climb from both ends, filling the result from its two sides
+        auto front = result.begin();
+        for (; u != top; u = _parent[u]) {
+            *front++ = _nodes[u];
+        }
+        *front = _nodes[top];
+
+        auto back = result.end();
+        for (; v != top; v = _parent[v]) {
+            *--back = _nodes[v];
+        }
+
+        return result;
+    }
+};
+
+} // namespace tools::detail
+
+#include <cpptools/_internal/undef_debug_macros.hpp>
+
+#endif//CPPTOOLS_CONTAINER_TREE_LCA_HPP
@@ -1,10 +1,12 @@
 #ifndef CPPTOOLS_CONTAINER_TREE_NODE_HPP
 #define CPPTOOLS_CONTAINER_TREE_NODE_HPP
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
+#include <span>
 #include <type_traits>
-#include <vector>
+#include <utility>
 
 #include <cpptools/exception/exception.hpp>
 #include <cpptools/exception/internal_exception.hpp>
@@ -12,6 +14,8 @@
 #include <cpptools/utility/merge_strategy.hpp>
 #include <cpptools/utility/detail/allocator.hpp>
 
+#include "child_storage.hpp"
+
 #ifndef CPPTOOLS_DEBUG_NODE
 # define CPPTOOLS_DEBUG_NODE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
 #endif
@@ -22,6 +26,9 @@
 
 namespace tools::detail {
 
+template<typename T, typename A>
+class node_pool;
+
 /// @brief A node in an arbitrary tree, to be used with unsafe_tree<T>.
 /// @note Enable debug assertions with #define CPPTOOLS_DEBUG_NODE 1
 template<typename T, typename A = std::allocator<T>>
@@ -35,35 +42,50 @@ private:
     using _al_traits = std::allocator_traits<allocator_type>;
 
 public:
-    using storage_type = std::vector<node*, rebind_alloc_t<_al_type, node*>>;
-    using size_type = typename storage_type::size_type;
+    /// @brief Amount of children whose pointers are stored inside the node,
+    /// nodes with more children store them in a separate heap buffer. Chosen
+    /// so that a node fills a cache line on 64-bit targets, given an allocator
+    /// without state.
+    static constexpr std::size_t inline_child_capacity = 4;
 
-    /// @brief Value attached to this node
-    value_type value;
+    using storage_type = child_storage<node*, inline_child_capacity, rebind_alloc_t<_al_type, node*>>;
+    using size_type = typename storage_type::size_type;
 
 private:
+    /// @brief Assumed cache line size, std::hardware_destructive_interference_size
+    /// not being ABI-stable
+    static constexpr std::size_t _cache_line = 64;
+
     node(const node&  other) = delete;
     node(      node&& other) = delete;
     node& operator=(const node&  other) = delete;
     node& operator=(      node&& other) = delete;
 
-    /// @brief Pointer to the parent of this node
-    node* _parent;
+    /// @brief Pointer to the parent of this node. Nodes are aligned on cache
+    /// lines, so that a node never straddles two of them.
+    alignas(_cache_line) node* _parent;
+
+    /// @brief Pointers to the children of this node, laid out next to the
+    /// parent pointer so that those of small nodes share its cache line
+    storage_type _children;
 
-    /// @brief Index of this node in its parent's vector of children nodes
+    /// @brief Index of this node in its parent's sequence of children nodes
     size_type _sibling_index;
 
-    /// @brief Pointers to the children of this node
-    storage_type _children;
+    /// @brief Index of the slot holding this node in its node pool, which
+    /// also locates the value attached to this node
+    size_type _pool_slot;
 
+    friend class node_pool<T, A>;
 
 public:
-    template<typename ...ArgTypes>
-    node(ArgTypes&&... args) noexcept(std::is_nothrow_constructible_v<T, ArgTypes...>):
-        value{std::forward<ArgTypes>(args)...},
+    /// @param pool_slot Index of the slot of the node pool holding the node
+    /// and its value
+    explicit node(size_type pool_slot) noexcept :
         _parent(nullptr),
+        _children(),
         _sibling_index(),
-        _children()
+        _pool_slot(pool_slot)
     {
 
     }
@@ -127,6 +149,28 @@ public:
         child->_sibling_index = _children.size() - 1;
     }
 
+    /// @brief Insert a new child node at some position among the children of
+    /// this node, updating the \c _parent pointer and \c _sibling_index in the
+    /// child node and its right siblings
+    /// @param child Pointer to the node to insert as a new child
+    /// @param index Position of the new child among the children of this node
+    /// @pre \c child must not be null.
+    /// @pre \c child must point to an orphaned node.
+    /// @pre \c index must not be greater than the amount of children.
+    void insert_child(node* child, size_type index) {
+        CPPTOOLS_DEBUG_ASSERT(not_null(child),          "node", critical, "child to be inserted is null", exception::parameter::null_parameter_error, "child");
+        CPPTOOLS_DEBUG_ASSERT(index <= _children.size(), "node", critical, "index out of bounds",          exception::parameter::invalid_value_error, "index", index);
+
+        auto it = _children.insert(_children.begin() + index, child);
+        child->_parent = this;
+
+        // set the sibling index of the new child and its right siblings
+        auto end = _children.end();
+        for (; it != end; ++it) {
+            (*it)->_sibling_index = index++;
+        }
+    }
+
     /// @brief Remove a child from this node
     /// @param index Index of the child node to be removed
     /// @pre \c child must not be a valid index in this node's vector of
@@ -151,6 +195,49 @@ public:
         return removed_child;
     }
 
+    /// @brief Remove a child from this node, leaving a null entry in its place
+    /// so that the sibling index of its right siblings remains valid
+    /// @param index Index of the child node to be removed
+    /// @return A pointer to the removed child
+    /// @note Null entries must be dropped through \c compact_children before
+    /// the children of this node are inspected in any other way.
+    node* vacate_child(size_type index) CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(index < _children.size(), "node", critical, "index out of bounds", exception::parameter::invalid_value_error, "index", index);
+
+        return std::exchange(_children[index], nullptr);
+    }
+
+    /// @brief Drop the null entries left among the children of this node by
+    /// \c vacate_child, and renumber the remaining children
+    void compact_children() noexcept {
+        // children left of the first null entry keep their place
+        auto first = std::find(_children.begin(), _children.end(), nullptr);
+        auto index = static_cast<size_type>(first - _children.begin());
+
+        auto end = std::remove(first, _children.end(), nullptr);
+        _children.erase(end, _children.end());
+
+        for (auto it = _children.begin() + index; it != _children.end(); ++it) {
+            (*it)->_sibling_index = index++;
+        }
+    }
+
+    /// @brief Remove a range of children from this node, shifting their right
+    /// siblings and rewriting their sibling index in a single pass
+    /// @param first Index of the first child node to be removed
+    /// @param last Index past the last child node to be removed
+    /// @note The parent metadata of the removed children is left untouched,
+    /// see \c remove_child.
+    void remove_children(size_type first, size_type last) CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(first <= last && last <= _children.size(), "node", critical, "index out of bounds", exception::parameter::invalid_value_error, "last", last);
+
+        auto it = _children.erase(_children.begin() + first, _children.begin() + last);
+
+        for (; it != _children.end(); ++it) {
+            (*it)->_sibling_index = first++;
+        }
+    }
+
     /// @brief Merge the child node at the specified index: its value is
     /// merged with this node's value according to the provided merging
     /// strategy, and its children are adopted in its place. The child node
@@ -168,54 +255,41 @@ public:
         CPPTOOLS_DEBUG_ASSERT(merge_index < _children.size(), "node", critical, "index out of bounds", exception::parameter::invalid_value_error, "index", merge_index);
 
         node* to_merge = _children[merge_index];
-        std::vector<node*> to_adopt = to_merge->release_children();
-        std::size_t adopted_count = to_adopt.size();
-
-        if (adopted_count != 0) {
-            std::size_t child_count           = _children.size();
-            std::size_t right_sibling_count   = child_count - 1 - to_merge->sibling_index();
-            std::size_t additional_node_count = adopted_count - 1; // -1: the node to merge will be overwritten and this does not count as an insertion
-            _children.resize(child_count + additional_node_count, nullptr);
-            auto to_merge_it = _children.begin() + merge_index;
-
-            if (right_sibling_count > 0 && adopted_count > 1) {
-                // move right siblings of the node to merge at the end of the resized children vector
-                auto it_right_sibling = to_merge_it + 1;
-                std::copy_backward(it_right_sibling, it_right_sibling + right_sibling_count, _children.end());
-            }
+        const auto& to_adopt = to_merge->_children;
+        const std::size_t adopted_count = to_adopt.size();
 
-            // adopt grand-children
-            for (auto new_child : to_adopt) {
-                new_child->_parent = this;
-                *(to_merge_it++) = new_child;
-            }
-        } else {
-            auto to_merge_it = _children.begin() + merge_index;
+        // replace the node to merge with its children
+        auto to_merge_it = _children.begin() + merge_index;
+        if (adopted_count == 0) {
             _children.erase(to_merge_it);
+        } else {
+            *to_merge_it = to_adopt.front();
+            _children.insert(to_merge_it + 1, to_adopt.begin() + 1, to_adopt.end());
         }
 
-        // sibling indices of nodes that were moved around may need to be updated
-        // compute the range of such nodes
+        for (node* new_child : to_adopt) {
+            new_child->_parent = this;
+        }
 
-        // start of the range: decide whether the adopted nodes need updating, or not (in which case they can be skipped)
+        // sibling indices of adopted nodes need updating unless they were
+        // inserted first, those of right siblings unless they were not moved
         std::size_t start_offset = (merge_index == 0)
-                ? adopted_count     // adopted nodes inserted as first children, sibling index remained up-to-date => skip them
-                : merge_index;      // adopted nodes inserted in the middle, sibling index needs update => include them
-
-        auto outdated_it = _children.begin() + start_offset;
+            ? adopted_count
+            : merge_index;
 
-        // end of the range: decide whether the right sibling nodes need updating, or not (in which case they can be omitted)
-        auto outdated_index_end = (adopted_count == 1)
-            ? _children.begin() + (merge_index + adopted_count) // right siblings were not moved, sibling index remained up-to-date => omit them
-            : _children.end();                                  // right siblings were moved, sibling index needs update => include them
+        auto outdated_it  = _children.begin() + start_offset;
+        auto outdated_end = (adopted_count == 1)
+            ? _children.begin() + (merge_index + adopted_count)
+            : _children.end();
 
-        // update the sibling index of the nodes in the computed range
-        for (; outdated_it != outdated_index_end; ++outdated_it) {
+        for (; outdated_it < outdated_end; ++outdated_it) {
             (*outdated_it)->_sibling_index = start_offset++;
         }
 
+        to_merge->_children.clear();
+
         // merge the node value into this node's value
-        merge_t{}(value, std::move(to_merge->value));
+        merge_t{}(value(), std::move(to_merge->value()));
     }
 
     bool has_parent(const node* n) const CPPTOOLS_NOEXCEPT_RELEASE {
@@ -233,13 +307,27 @@ public:
         return false;
     }
 
+    /// @brief Get the value attached to this node, which the node pool
+    /// stores next to the slot of the node
+    value_type& value() noexcept {
+        return node_pool<T, A>::value_of(this);
+    }
+
+    /// @brief Get the value attached to this node, which the node pool
+    /// stores next to the slot of the node
+    const value_type& value() const noexcept {
+        return node_pool<T, A>::value_of(const_cast<node*>(this));
+    }
+
     void clear_parent_metadata() noexcept {
         _parent = nullptr;
         _sibling_index = 0;
     }
 
-    const std::vector<node*>& children() const noexcept {
-        return _children;
+    /// @brief Get a view of the pointers to the children of this node
+    /// @note The view is invalidated by any insertion or removal of children.
+    std::span<node* const> children() const noexcept {
+        return _children.span();
     }
 
     node* child(size_t index) const noexcept {
@@ -250,6 +338,9 @@ public:
         return _children.size();
     }
 
+    /// @brief Get the amount of nodes below this one
+    /// @note This counts the nodes of the subtree, see
+    /// unsafe_tree::descendant_count for a constant-time alternative.
     size_type descendant_count() const noexcept {
         return std::accumulate(
             _children.begin(), _children.end(), size_type{},
@@ -263,13 +354,6 @@ public:
         return _parent;
     }
 
-    [[nodiscard]] std::vector<node*> release_children() noexcept {
-        std::vector<node*> result = std::move(_children);
-        _children.clear();
-
-        return result;
-    }
-
     size_t sibling_index() const CPPTOOLS_NOEXCEPT_RELEASE {
         CPPTOOLS_DEBUG_ASSERT(not_null(_parent), "node", critical, "node has no parent", exception::internal::precondition_failure_error);
 
@@ -281,6 +365,10 @@ public:
     }
 };
 
+// Only holds for allocators without state: a stateful allocator stored in the
+// child storage makes nodes span two cache lines.
+static_assert(sizeof(void*) != 8 || sizeof(node<int>) == 64, "on 64-bit targets, a node with the default allocator fills exactly one cache line");
+
 } // namespace tools::detail
 
 #include <cpptools/_internal/undef_debug_macros.hpp>
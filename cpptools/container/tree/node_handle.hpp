@@ -67,7 +67,7 @@ public:
     const_reference value() const CPPTOOLS_NOEXCEPT_RELEASE {
         CPPTOOLS_DEBUG_ASSERT(not_null(_node), "const_node_handle", critical, "node handle is null", exception::internal::precondition_failure_error);
 
-        return _node->value;
+        return _node->value();
     }
 
     const_node_handle left_sibling() const CPPTOOLS_NOEXCEPT_RELEASE {
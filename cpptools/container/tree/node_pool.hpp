@@ -0,0 +1,609 @@
+#ifndef CPPTOOLS_CONTAINER_TREE_NODE_POOL_HPP
+#define CPPTOOLS_CONTAINER_TREE_NODE_POOL_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/internal_exception.hpp>
+#include <cpptools/utility/attributes.hpp>
+#include <cpptools/utility/detail/allocator.hpp>
+
+#include "node.hpp"
+
+namespace tools::detail {
+
+/// @brief Slab storage for the nodes of one or more unsafe_tree<T>.
+/// @details Nodes are carved out of fixed-size blocks which are never
+/// reallocated, so that a node keeps the same address for as long as it lives.
+/// Slots of destroyed nodes are recycled through an intrusive free list, which
+/// makes node creation and destruction a matter of a few pointer bumps in the
+/// steady state. Every live slot is tagged with the ID of the tree which owns
+/// the node held in it, so that several trees (for instance a tree and the
+/// subtrees which were chopped off of it) can share a pool.
+/// While several owners use the pool, every operation on the pool structure
+/// takes a lock, so that trees sharing the pool can be mutated from different
+/// threads. Locking stops once owners released themselves down to one. Trees sharing a pool keep all of its blocks alive,
+/// iterate over all of its blocks, and index their side data by slots of the
+/// whole pool.
+/// Within a block, values are stored apart from the nodes they are attached
+/// to, so that iterating over values reads them sequentially without dragging
+/// the node structure through the cache.
+/// @tparam T Type of values held by the nodes
+/// @tparam A Allocator type
+template<typename T, typename A = std::allocator<T>>
+class node_pool {
+public:
+    using node_t    = node<T, A>;
+    using size_type = typename node_t::size_type;
+    using owner_id  = std::uint32_t;
+
+    /// @brief Number of node slots in a block
+    static constexpr size_type BlockCapacity = 64;
+
+private:
+    using _mask_t = std::uint64_t;
+
+    static_assert(BlockCapacity == std::numeric_limits<_mask_t>::digits, "block liveness is tracked in a single bit mask");
+    static_assert(sizeof(node_t) >= sizeof(size_type), "free slots must be able to hold a slot index");
+
+    struct _block {
+        /// @brief Bit N is set if and only if slot N holds a live node
+        _mask_t live;
+
+        /// @brief ID of the tree owning the node held in each slot
+        owner_id owners[BlockCapacity];
+
+        /// @brief Raw storage for the values
+        alignas(T) std::byte values[BlockCapacity][sizeof(T)];
+
+        /// @brief Raw storage for the nodes
+        alignas(node_t) std::byte slots[BlockCapacity][sizeof(node_t)];
+    };
+
+    static_assert(sizeof(_block::values) == BlockCapacity * sizeof(T), "values of a block are packed in slot order, apart from the nodes");
+
+    using _al_value     = rebind_alloc_t<A, T>;
+    using _al_node      = rebind_alloc_t<A, node_t>;
+    using _al_block     = rebind_alloc_t<A, _block>;
+    using _value_traits = std::allocator_traits<_al_value>;
+    using _node_traits  = std::allocator_traits<_al_node>;
+    using _traits       = std::allocator_traits<_al_block>;
+    using _block_list  = std::vector<_block*, rebind_alloc_t<A, _block*>>;
+
+    static constexpr size_type _npos = std::numeric_limits<size_type>::max();
+
+    /// @brief Allocator used for blocks
+    NO_UNIQUE_ADDR _al_block _alloc;
+
+    /// @brief Allocator used to construct and destroy values
+    NO_UNIQUE_ADDR _al_value _value_alloc;
+
+    /// @brief Allocator used to construct and destroy nodes
+    NO_UNIQUE_ADDR _al_node _node_alloc;
+
+    /// @brief Blocks of slots, in slot index order
+    _block_list _blocks;
+
+    /// @brief Index of the first slot in the free list, _npos if the list is
+    /// empty
+    size_type _free_head;
+
+    /// @brief Length of the free list
+    size_type _free_count;
+
+    /// @brief Slots past this index were never handed out
+    size_type _bump;
+
+    /// @brief Amount of live nodes in the pool
+    size_type _size;
+
+    /// @brief Next owner ID to be handed out
+    owner_id _next_owner;
+
+    /// @brief Amount of owners handed out and not released yet
+    owner_id _owner_count;
+
+    /// @brief Whether several owners currently use the pool, in which case
+    /// their trees may use it from different threads
+    std::atomic<bool> _shared;
+
+    /// @brief Protection around the blocks, their slot masks and owner tags,
+    /// and the free list, once the pool is shared
+    mutable std::mutex _mutex;
+
+    /// @brief Lock the pool if it is shared
+    std::unique_lock<std::mutex> _lock() const {
+        if (!_shared.load(std::memory_order_acquire)) {
+            return {};
+        }
+
+        return std::unique_lock<std::mutex>(_mutex);
+    }
+
+    _block* _block_of(size_type slot) const noexcept {
+        return _blocks[slot / BlockCapacity];
+    }
+
+    std::byte* _bytes_of(size_type slot) const noexcept {
+        return _block_of(slot)->slots[slot % BlockCapacity];
+    }
+
+    static node_t* _node_in(_block* b, size_type index) noexcept {
+        return std::launder(reinterpret_cast<node_t*>(b->slots[index]));
+    }
+
+    static T* _value_in(_block* b, size_type index) noexcept {
+        return std::launder(reinterpret_cast<T*>(b->values[index]));
+    }
+
+    /// @brief Get the block holding a node, from its address and slot index
+    static _block* _enclosing_block(node_t* n) noexcept {
+        auto slots = reinterpret_cast<std::byte*>(n) - (n->_pool_slot % BlockCapacity) * sizeof(node_t);
+
+        return std::launder(reinterpret_cast<_block*>(slots - offsetof(_block, slots)));
+    }
+
+    /// @brief Destroy the value and the node held in a live slot
+    void _destroy_in(_block* b, size_type index) noexcept(std::is_nothrow_destructible_v<T>) {
+        _node_traits::destroy(_node_alloc, _node_in(b, index));
+        _value_traits::destroy(_value_alloc, _value_in(b, index));
+    }
+
+    size_type _capacity() const noexcept {
+        return _blocks.size() * BlockCapacity;
+    }
+
+    void _allocate_block() {
+        _blocks.reserve(_blocks.size() + 1);
+
+        _block* b = _traits::allocate(_alloc, 1);
+        b->live = 0;
+        _blocks.push_back(b);
+    }
+
+    void _push_free(size_type slot) noexcept {
+        std::memcpy(_bytes_of(slot), &_free_head, sizeof(size_type));
+        _free_head = slot;
+        ++_free_count;
+    }
+
+    size_type _pop_free() noexcept {
+        size_type slot = _free_head;
+        std::memcpy(&_free_head, _bytes_of(slot), sizeof(size_type));
+        --_free_count;
+
+        return slot;
+    }
+
+    size_type _acquire_slot() {
+        if (_free_head != _npos) {
+            return _pop_free();
+        }
+
+        if (_bump == _capacity()) {
+            _allocate_block();
+        }
+
+        return _bump++;
+    }
+
+    /// @brief Hand all never-used slots over to the free list
+    void _retire_tail() noexcept {
+        size_type capacity = _capacity();
+        while (_bump != capacity) {
+            _push_free(_bump++);
+        }
+    }
+
+    /// @brief Bit mask of the slots in a block which hold a node belonging to
+    /// the provided owner
+    /// @pre The pool must be locked.
+    _mask_t _owned_mask(const _block* b, owner_id owner) const noexcept {
+        if (!_shared.load(std::memory_order_relaxed)) {
+            // a single owner uses the pool: owners which released themselves
+            // destroyed their nodes or handed them over to it
+            return b->live;
+        }
+
+        _mask_t owned = 0;
+        for (size_type i = 0; i < BlockCapacity; ++i) {
+            owned |= static_cast<_mask_t>(b->owners[i] == owner) << i;
+        }
+
+        return owned & b->live;
+    }
+
+public:
+    /// @brief Forward iterator over the values of the nodes belonging to an
+    /// owner, in memory order.
+    template<bool Is_const>
+    class basic_iterator {
+        friend class node_pool;
+
+        template<bool>
+        friend class basic_iterator;
+
+        using pool_t   = std::conditional_t<Is_const, const node_pool, node_pool>;
+        using _block_t = typename node_pool::_block;
+
+        /// @brief Pool being iterated over
+        pool_t* _pool;
+
+        /// @brief Index of the block being iterated over
+        size_type _block;
+
+        /// @brief Block being iterated over, null past the last block
+        _block_t* _current;
+
+        /// @brief Slots of the current block which remain to be visited
+        _mask_t _pending;
+
+        /// @brief Owner whose nodes are iterated over
+        owner_id _owner;
+
+        basic_iterator(pool_t* pool, size_type block, owner_id owner) :
+            _pool(pool),
+            _block(block),
+            _current(nullptr),
+            _pending(0),
+            _owner(owner)
+        {
+            auto l = _pool->_lock();
+            if (_block < _pool->_blocks.size()) {
+                _current = _pool->_blocks[_block];
+                _pending = _pool->_owned_mask(_current, _owner);
+                _settle_locked();
+            }
+        }
+
+        /// @brief Move on to the next block holding nodes of the owner if the
+        /// current one has none left
+        void _settle() {
+            if (_pending == 0) {
+                auto l = _pool->_lock();
+                _settle_locked();
+            }
+        }
+
+        /// @pre The pool must be locked.
+        void _settle_locked() noexcept {
+            const size_type block_count = _pool->_blocks.size();
+            while (_pending == 0) {
+                if (++_block == block_count) {
+                    _current = nullptr;
+                    return;
+                }
+
+                _current = _pool->_blocks[_block];
+                _pending = _pool->_owned_mask(_current, _owner);
+            }
+        }
+
+    public:
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Is_const, const T&, T&>;
+        using pointer           = std::conditional_t<Is_const, const T*, T*>;
+        using iterator_category = std::forward_iterator_tag;
+
+        basic_iterator() noexcept :
+            _pool(nullptr),
+            _block(0),
+            _current(nullptr),
+            _pending(0),
+            _owner(0)
+        {
+
+        }
+
+        template<bool Was_const> requires (Is_const && !Was_const)
+        basic_iterator(const basic_iterator<Was_const>& other) noexcept :
+            _pool(other._pool),
+            _block(other._block),
+            _current(other._current),
+            _pending(other._pending),
+            _owner(other._owner)
+        {
+
+        }
+
+        reference operator*() const noexcept {
+            return *_value_in(_current, std::countr_zero(_pending));
+        }
+
+        pointer operator->() const noexcept {
+            return &(**this);
+        }
+
+        basic_iterator& operator++() {
+            _pending &= _pending - 1;
+            _settle();
+
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator tmp = *this;
+            ++*this;
+
+            return tmp;
+        }
+
+        bool operator==(const basic_iterator& rhs) const noexcept {
+            // Blocks may be added by other owners while iterating: all
+            // iterators past the last block compare equal
+            return _current == rhs._current && _pending == rhs._pending;
+        }
+    };
+
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    node_pool(const A& alloc = {}) :
+        _alloc(alloc),
+        _value_alloc(alloc),
+        _node_alloc(alloc),
+        _blocks(rebind_alloc_t<A, _block*>(alloc)),
+        _free_head(_npos),
+        _free_count(0),
+        _bump(0),
+        _size(0),
+        _next_owner(0),
+        _owner_count(0),
+        _shared(false),
+        _mutex()
+    {
+
+    }
+
+    node_pool(const node_pool&) = delete;
+    node_pool(node_pool&&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+    node_pool& operator=(node_pool&&) = delete;
+
+    ~node_pool() {
+        clear();
+    }
+
+    /// @brief Get a new owner ID, unique within this pool
+    /// @exception tools::exception::internal::out_of_memory_error All owner
+    /// IDs were handed out already.
+    owner_id make_owner() {
+        auto l = std::unique_lock<std::mutex>(_mutex);
+        if (_next_owner == std::numeric_limits<owner_id>::max()) {
+            CPPTOOLS_THROW(exception::internal::out_of_memory_error).with_message("node pool ran out of owner IDs");
+        }
+
+        if (++_owner_count == 2) {
+            _shared.store(true, std::memory_order_release);
+        }
+
+        return _next_owner++;
+    }
+
+    /// @brief Report that an owner stopped using the pool, for it to stop
+    /// locking once a single owner is left
+    /// @note The owner must not use the pool after releasing itself.
+    void release_owner() noexcept {
+        auto l = std::unique_lock<std::mutex>(_mutex);
+        if (--_owner_count == 1) {
+            // the remaining owner synchronizes with this store on its next
+            // call, and sees everything the released owner did to the pool
+            _shared.store(false, std::memory_order_release);
+        }
+    }
+
+    /// @brief Construct a new node in a free slot
+    /// @param owner ID of the tree the new node belongs to
+    /// @param args Arguments to be forwarded to the constructor of the value
+    /// @return A pointer to the new node
+    /// @exception Any exception thrown in the constructor of the value will be
+    /// forwarded to the caller, the pool is left unchanged
+    /// @note A shared pool stays locked while the value is constructed, so
+    /// that creating a node only takes the lock once.
+    template<typename... ArgTypes>
+    [[nodiscard]] node_t* create(owner_id owner, ArgTypes&&... args) {
+        auto l = _lock();
+        size_type slot = _acquire_slot();
+        _block* b = _block_of(slot);
+
+        size_type index = slot % BlockCapacity;
+        T* value = reinterpret_cast<T*>(b->values[index]);
+
+        try {
+            _value_traits::construct(_value_alloc, value, std::forward<ArgTypes>(args)...);
+        } catch (...) {
+            _push_free(slot);
+            throw;
+        }
+
+        node_t* n = reinterpret_cast<node_t*>(b->slots[index]);
+        _node_traits::construct(_node_alloc, n, slot);
+
+        b->owners[index] = owner;
+        b->live |= _mask_t{1} << index;
+        ++_size;
+
+        return n;
+    }
+
+    /// @brief Destroy a node and recycle its slot
+    /// @param n Node to destroy
+    void destroy(node_t* n) noexcept(std::is_nothrow_destructible_v<T>) {
+        size_type slot  = n->_pool_slot;
+        size_type index = slot % BlockCapacity;
+
+        auto l = _lock();
+        _block* b = _block_of(slot);
+        _destroy_in(b, index);
+        b->live &= ~(_mask_t{1} << index);
+        _push_free(slot);
+        --_size;
+    }
+
+    /// @brief Make sure that at least \c count nodes can be created without
+    /// the pool having to allocate
+    void reserve(size_type count) {
+        auto l = _lock();
+        while (_free_count + (_capacity() - _bump) < count) {
+            _allocate_block();
+        }
+    }
+
+    /// @brief Get the amount of slots in the pool, live or not
+    size_type capacity() const {
+        auto l = _lock();
+        return _capacity();
+    }
+
+    /// @brief Get the index of the slot holding a node, lower than
+    /// \c capacity()
+    static size_type slot_of(const node_t* n) noexcept {
+        return n->_pool_slot;
+    }
+
+    /// @brief Get the value attached to a live node
+    static T& value_of(node_t* n) noexcept {
+        return *_value_in(_enclosing_block(n), n->_pool_slot % BlockCapacity);
+    }
+
+    /// @brief Get the ID of the tree owning a node
+    owner_id owner_of(const node_t* n) const {
+        auto l = _lock();
+        return _block_of(n->_pool_slot)->owners[n->_pool_slot % BlockCapacity];
+    }
+
+    /// @brief Change the ID of the tree owning a node
+    void set_owner(const node_t* n, owner_id owner) {
+        auto l = _lock();
+        _block_of(n->_pool_slot)->owners[n->_pool_slot % BlockCapacity] = owner;
+    }
+
+    /// @brief Tell whether a node lives in this pool and belongs to an owner
+    bool owns(const node_t* n, owner_id owner) const {
+        size_type slot = n->_pool_slot;
+
+        auto l = _lock();
+        return slot < _capacity()
+            && _node_in(_block_of(slot), slot % BlockCapacity) == n
+            && (_block_of(slot)->live & (_mask_t{1} << (slot % BlockCapacity))) != 0
+            && _block_of(slot)->owners[slot % BlockCapacity] == owner;
+    }
+
+    /// @brief Steal all blocks of another pool, along with the nodes they
+    /// contain. Node addresses remain valid.
+    /// @param other Pool to steal blocks from
+    /// @param owner ID of the owner which stolen nodes should be handed over to
+    /// @pre Both pools must use equal allocators.
+    /// @pre All nodes in \c other must belong to the same owner.
+    /// @pre \c other must not be shared.
+    void merge(node_pool& other, owner_id owner) {
+        auto l = _lock();
+        _blocks.reserve(_blocks.size() + other._blocks.size());
+
+        // slot indices must remain dense: never-used slots are made free slots
+        _retire_tail();
+        other._retire_tail();
+
+        const size_type offset = _capacity();
+
+        // shift the links of the other free list, and chain its tail to the
+        // head of this free list
+        if (other._free_head != _npos) {
+            size_type slot = other._free_head;
+            while (true) {
+                size_type next;
+                std::memcpy(&next, other._bytes_of(slot), sizeof(size_type));
+
+                size_type link = (next == _npos) ? _free_head : next + offset;
+                std::memcpy(other._bytes_of(slot), &link, sizeof(size_type));
+
+                if (next == _npos) {
+                    break;
+                }
+                slot = next;
+            }
+
+            _free_head = other._free_head + offset;
+        }
+
+        for (_block* b : other._blocks) {
+            for (_mask_t live = b->live; live != 0; live &= live - 1) {
+                size_type index = std::countr_zero(live);
+                _node_in(b, index)->_pool_slot += offset;
+                b->owners[index] = owner;
+            }
+
+            _blocks.push_back(b);
+        }
+
+        _size       += other._size;
+        _free_count += other._free_count;
+        _bump        = _capacity();
+
+        other._blocks.clear();
+        other._free_head  = _npos;
+        other._free_count = 0;
+        other._bump       = 0;
+        other._size       = 0;
+    }
+
+    /// @brief Destroy all nodes and release all blocks
+    /// @pre No other owner may use the pool concurrently.
+    void clear() noexcept(std::is_nothrow_destructible_v<T>) {
+        for (_block* b : _blocks) {
+            for (_mask_t live = b->live; live != 0; live &= live - 1) {
+                _destroy_in(b, std::countr_zero(live));
+            }
+
+            _traits::deallocate(_alloc, b, 1);
+        }
+
+        _blocks.clear();
+        _free_head  = _npos;
+        _free_count = 0;
+        _bump       = 0;
+        _size       = 0;
+    }
+
+    /// @brief Get the amount of live nodes in the pool, all owners included
+    size_type size() const {
+        auto l = _lock();
+        return _size;
+    }
+
+    /// @brief Get an iterator to the first value belonging to an owner
+    iterator begin(owner_id owner) {
+        return iterator(this, 0, owner);
+    }
+
+    /// @brief Get an iterator past the last value belonging to an owner
+    iterator end(owner_id) noexcept {
+        return iterator();
+    }
+
+    /// @copydoc node_pool::begin
+    const_iterator begin(owner_id owner) const {
+        return const_iterator(this, 0, owner);
+    }
+
+    /// @copydoc node_pool::end
+    const_iterator end(owner_id) const noexcept {
+        return const_iterator();
+    }
+};
+
+} // namespace tools::detail
+
+#endif//CPPTOOLS_CONTAINER_TREE_NODE_POOL_HPP
@@ -0,0 +1,240 @@
+#ifndef CPPTOOLS_CONTAINER_TREE_PARALLEL_HPP
+#define CPPTOOLS_CONTAINER_TREE_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/internal_exception.hpp>
+#include <cpptools/thread/thread_pool.hpp>
+
+#include "traversal.hpp"
+#include "unsafe_tree.hpp"
+
+namespace tools::detail {
+
+/// @brief Trees smaller than this are always processed on the calling thread
+inline constexpr std::size_t parallel_tree_min_size = 1 << 14;
+
+/// @brief Amount of subtrees to aim for per thread, so that threads which
+/// were handed small subtrees can pick up more work
+inline constexpr std::size_t parallel_tree_subtrees_per_thread = 8;
+
+/// @brief Split of a tree into work items, in pre-order: nodes near the root
+/// are visited on their own, nodes at the split depth stand for their whole
+/// subtree.
+template<typename Node>
+struct parallel_tree_plan {
+    struct item {
+        Node* node;
+        bool  whole_subtree;
+    };
+
+    /// @brief Work items, in the pre-order of their nodes
+    std::vector<item> items;
+
+    /// @brief Indices in \c items of the items standing for whole subtrees
+    std::vector<std::size_t> subtrees;
+};
+
+/// @brief Split a tree at the shallowest depth which is wide enough to keep
+/// all threads busy
+template<typename Node>
+parallel_tree_plan<Node> make_parallel_tree_plan(Node* root, std::size_t target_width) {
+    parallel_tree_plan<Node> plan;
+
+    // find the split depth by widening the front one level at a time
+    std::vector<Node*> front = { root };
+    std::vector<Node*> next;
+    std::size_t split_depth = 0;
+
+    while (front.size() < target_width) {
+        next.clear();
+        for (Node* n : front) {
+            next.insert(next.end(), n->children().begin(), n->children().end());
+        }
+
+        if (next.empty()) {
+            break;
+        }
+
+        std::swap(front, next);
+        ++split_depth;
+    }
+
+    // lay out items in pre-order, without descending past the split depth
+    std::vector<std::pair<Node*, std::size_t>> stack = { { root, 0 } };
+    while (!stack.empty()) {
+        auto [n, depth] = stack.back();
+        stack.pop_back();
+
+        if (depth == split_depth) {
+            plan.subtrees.push_back(plan.items.size());
+            plan.items.push_back({ n, true });
+            continue;
+        }
+
+        plan.items.push_back({ n, false });
+
+        const auto& children = n->children();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.push_back({ *it, depth + 1 });
+        }
+    }
+
+    return plan;
+}
+
+/// @brief Get the node following another in a pre-order traversal of a
+/// subtree, null if there is none
+template<typename Node>
+Node* next_in_subtree(std::type_identity_t<const Node*> subtree_root, Node* n) noexcept {
+    if (n->child_count() != 0) {
+        return n->child(0);
+    }
+
+    while (n != subtree_root && n->is_rightmost_sibling()) {
+        n = n->parent();
+    }
+
+    return (n == subtree_root)
+        ? nullptr
+        : n->right_sibling();
+}
+
+/// @brief Get the thread pool shared by all parallel tree algorithms, which
+/// is started on first use. The calling thread takes part in the work, so the
+/// pool leaves it a hardware thread.
+inline thread_pool& parallel_tree_pool() {
+    static thread_pool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+
+    return pool;
+}
+
+/// @brief Amount of subtrees to split a tree into so that all threads taking
+/// part in the work get several of them
+inline std::size_t parallel_tree_target_width() {
+    return (parallel_tree_pool().size() + 1) * parallel_tree_subtrees_per_thread;
+}
+
+/// @brief Run a function on a set of work items from the threads of the
+/// shared pool and the calling thread, each picking the next unprocessed item
+/// until there are none left
+/// @param count Amount of work items
+/// @param f Function to run on each work item index
+/// @exception The first exception thrown by \c f is forwarded to the caller,
+/// once all items which were started are done
+template<typename F>
+void parallel_tree_run(std::size_t count, F&& f) {
+    parallel_tree_pool().parallel_for(0, count, std::forward<F>(f), 1);
+}
+
+/// @brief Reduce the values of a tree, in parallel over its subtrees
+/// @param t Tree whose values to reduce
+/// @param map Function mapping a value to a partial result
+/// @param combine Function combining two partial results, must be
+/// associative
+/// @return The combination of the mapped values of all nodes, in pre-order,
+/// or a value-initialized result if the tree is empty
+/// @exception tools::exception::internal::precondition_failure_error The tree
+/// is empty and the result type is not default-constructible.
+/// @note The result only depends on the shape of the tree, not on thread
+/// scheduling.
+template<typename T, typename Map, typename Combine>
+auto parallel_reduce(const unsafe_tree<T>& t, Map map, Combine combine) {
+    using node_t   = const typename unsafe_tree<T>::node_t;
+    using result_t = std::decay_t<std::invoke_result_t<Map&, const T&>>;
+
+    auto fold_subtree = [&](node_t* subtree_root) {
+        result_t result = std::invoke(map, subtree_root->value());
+        for (node_t* n = next_in_subtree(subtree_root, subtree_root); n != nullptr; n = next_in_subtree(subtree_root, n)) {
+            result = std::invoke(combine, std::move(result), std::invoke(map, n->value()));
+        }
+
+        return result;
+    };
+
+    if (t.empty()) {
+        if constexpr (std::is_default_constructible_v<result_t>) {
+            return result_t{};
+        } else {
+            CPPTOOLS_THROW(exception::internal::precondition_failure_error).with_message("cannot reduce an empty tree to a result type with no default value");
+        }
+    }
+
+    if (t.size() < parallel_tree_min_size) {
+        return fold_subtree(t.root());
+    }
+
+    auto plan = make_parallel_tree_plan(t.root(), parallel_tree_target_width());
+
+    // every partial result is set before being combined, the result type
+    // need not have a default value
+    std::vector<std::optional<result_t>> partials(plan.subtrees.size());
+    parallel_tree_run(plan.subtrees.size(), [&](std::size_t i) {
+        partials[i].emplace(fold_subtree(plan.items[plan.subtrees[i]].node));
+    });
+
+    // combine partial results in the order of the items
+    auto partial = partials.begin();
+    auto item_result = [&](const auto& item) {
+        return item.whole_subtree
+            ? std::move(**partial++)
+            : std::invoke(map, item.node->value());
+    };
+
+    result_t result = item_result(plan.items.front());
+    for (auto it = plan.items.begin() + 1; it != plan.items.end(); ++it) {
+        result = std::invoke(combine, std::move(result), item_result(*it));
+    }
+
+    return result;
+}
+
+/// @brief Apply a function to all values of a tree, in parallel over its
+/// subtrees
+/// @param t Tree whose values to process
+/// @param f Function to apply to each value
+/// @note The order in which values are processed is unspecified. \c f must
+/// be safe to call concurrently on different values.
+template<typename T, any_cvref<unsafe_tree<T>> Tree, typename F>
+void parallel_for_each(Tree& t, F f) {
+    using node_t = std::conditional_t<std::is_const_v<Tree>, const typename Tree::node_t, typename Tree::node_t>;
+
+    auto visit_subtree = [&](node_t* subtree_root) {
+        for (node_t* n = subtree_root; n != nullptr; n = next_in_subtree(subtree_root, n)) {
+            std::invoke(f, n->value());
+        }
+    };
+
+    if (t.empty()) {
+        return;
+    }
+
+    if (t.size() < parallel_tree_min_size) {
+        visit_subtree(t.root());
+        return;
+    }
+
+    auto plan = make_parallel_tree_plan(t.root(), parallel_tree_target_width());
+
+    for (const auto& item : plan.items) {
+        if (!item.whole_subtree) {
+            std::invoke(f, item.node->value());
+        }
+    }
+
+    parallel_tree_run(plan.subtrees.size(), [&](std::size_t i) {
+        visit_subtree(plan.items[plan.subtrees[i]].node);
+    });
+}
+
+} // namespace tools::detail
+
+#endif//CPPTOOLS_CONTAINER_TREE_PARALLEL_HPP
@@ -1,9 +1,13 @@
 #ifndef CPPTOOLS_CONTAINER_TREE_TRAVERSAL_HPP
 #define CPPTOOLS_CONTAINER_TREE_TRAVERSAL_HPP
 
+#include <bit>
 #include <iterator>
 #include <ranges>
+#include <span>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <cpptools/exception/iterator_exception.hpp>
 #include <cpptools/utility/concepts.hpp>
@@ -275,13 +279,13 @@ public:
     reference operator*() const CPPTOOLS_NOEXCEPT_RELEASE {
         CPPTOOLS_DEBUG_ASSERT(not_null(_node), "tree", critical, "cannot dereference an iterator pointing at no node", exception::iterator::illegal_dereference_error);
 
-        return _node->value;
+        return _node->value();
     }
 
     pointer operator->() const CPPTOOLS_NOEXCEPT_RELEASE {
         CPPTOOLS_DEBUG_ASSERT(not_null(_node), "tree", critical, "cannot perform member access on an iterator pointing at no node", exception::iterator::illegal_dereference_error);
 
-        return &(_node->value);
+        return &(_node->value());
     }
 
     bool operator==(const const_dfs_iterator& rhs) const CPPTOOLS_NOEXCEPT_RELEASE {
@@ -502,6 +506,275 @@ public:
     }
 };
 
+/// @brief Proxy range-like object implementing BFS (level-order) traversal of
+/// a tree. Pending nodes are kept in a ring buffer owned by the proxy, which
+/// only grows when the traversal front gets wider than ever before.
+/// @note Iterators of a proxy share its state: this is an input range, which
+/// can be traversed several times by calling begin() again.
+template<typename T, bool Is_const>
+class bfs_proxy {
+    using container_t = std::conditional_t<Is_const, const unsafe_tree<T>, unsafe_tree<T>>;
+    using node_t      = std::conditional_t<Is_const, const typename container_t::node_t, typename container_t::node_t>;
+    using size_type   = typename container_t::size_type;
+    using handle_t    = std::conditional_t<Is_const, const_node_handle<T>, node_handle<T>>;
+
+    container_t& _tree;
+
+    /// @brief Ring buffer of pending nodes, its size is always a power of two
+    std::vector<node_t*> _queue;
+
+    /// @brief Index of the first pending node in the ring buffer
+    size_type _head;
+
+    /// @brief Amount of pending nodes in the ring buffer
+    size_type _count;
+
+    bfs_proxy(const bfs_proxy& other)            = delete;
+    bfs_proxy& operator=(const bfs_proxy& other) = delete;
+    bfs_proxy& operator=(bfs_proxy&& other)      = delete;
+
+    /// @brief Make sure that the ring buffer can hold a given amount of nodes,
+    /// unwrapping its contents if it needs to grow
+    void _ensure_capacity(size_type required) {
+        if (required <= _queue.size()) {
+            return;
+        }
+
+        std::vector<node_t*> grown(std::bit_ceil(required));
+        const size_type mask = _queue.size() - 1;
+        for (size_type i = 0; i < _count; ++i) {
+            grown[i] = _queue[(_head + i) & mask];
+        }
+
+        _queue = std::move(grown);
+        _head  = 0;
+    }
+
+    node_t* _front() const noexcept {
+        return _queue[_head];
+    }
+
+    /// @brief Pop the front node and push its children
+    void _advance() {
+        node_t* n = _front();
+        _head = (_head + 1) & (_queue.size() - 1);
+        --_count;
+
+        const auto& children = n->children();
+        _ensure_capacity(_count + children.size());
+
+        const size_type mask = _queue.size() - 1;
+        for (node_t* child : children) {
+            _queue[(_head + _count++) & mask] = child;
+        }
+    }
+
+public:
+    bfs_proxy(container_t& tree) noexcept :
+        _tree(tree),
+        _queue(),
+        _head(0),
+        _count(0)
+    {
+
+    }
+
+    bfs_proxy(bfs_proxy&& other) = default;
+
+    class iterator {
+        friend class bfs_proxy;
+
+        bfs_proxy* _proxy;
+
+        iterator(bfs_proxy* proxy) noexcept :
+            _proxy(proxy)
+        {
+
+        }
+
+    public:
+        using value_type      = T;
+        using difference_type = std::ptrdiff_t;
+        using reference       = std::conditional_t<Is_const, const T&, T&>;
+        using pointer         = std::conditional_t<Is_const, const T*, T*>;
+
+        iterator() noexcept :
+            _proxy(nullptr)
+        {
+
+        }
+
+        reference operator*() const CPPTOOLS_NOEXCEPT_RELEASE {
+            CPPTOOLS_DEBUG_ASSERT(_proxy->_count != 0, "tree", critical, "cannot dereference an iterator pointing at no node", exception::iterator::illegal_dereference_error);
+
+            return _proxy->_front()->value();
+        }
+
+        pointer operator->() const CPPTOOLS_NOEXCEPT_RELEASE {
+            return &(**this);
+        }
+
+        iterator& operator++() {
+            CPPTOOLS_DEBUG_ASSERT(_proxy->_count != 0, "tree", critical, "cannot prefix-increment a past-the-end iterator", exception::iterator::incremented_past_end_error);
+
+            _proxy->_advance();
+
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return _proxy->_count == 0;
+        }
+
+        handle_t as_node() const CPPTOOLS_NOEXCEPT_RELEASE {
+            return { _proxy->_front() };
+        }
+    };
+
+    /// @brief Start a traversal of the tree
+    iterator begin() {
+        _head  = 0;
+        _count = 0;
+
+        if (node_t* root = _tree.root()) {
+            _ensure_capacity(1);
+            _queue[0] = root;
+            _count = 1;
+        }
+
+        return iterator(this);
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return std::default_sentinel;
+    }
+};
+
+/// @brief Proxy range-like object yielding the nodes of a tree one depth
+/// level at a time, each level as a contiguous span of node handles.
+/// @note Iterators of a proxy share its state: this is an input range, and
+/// a span is only valid until the iterator is incremented.
+template<typename T, bool Is_const>
+class levels_proxy {
+    using container_t = std::conditional_t<Is_const, const unsafe_tree<T>, unsafe_tree<T>>;
+    using handle_t    = std::conditional_t<Is_const, const_node_handle<T>, node_handle<T>>;
+
+    container_t& _tree;
+
+    /// @brief Nodes of the level currently being visited
+    std::vector<handle_t> _current;
+
+    /// @brief Buffer in which the next level is gathered
+    std::vector<handle_t> _next;
+
+    levels_proxy(const levels_proxy& other)            = delete;
+    levels_proxy& operator=(const levels_proxy& other) = delete;
+    levels_proxy& operator=(levels_proxy&& other)      = delete;
+
+    /// @brief Replace the current level with the level below it
+    void _descend() {
+        _next.clear();
+        for (const handle_t& h : _current) {
+            for (handle_t child : h.children()) {
+                _next.push_back(child);
+            }
+        }
+
+        std::swap(_current, _next);
+    }
+
+public:
+    levels_proxy(container_t& tree) noexcept :
+        _tree(tree),
+        _current(),
+        _next()
+    {
+
+    }
+
+    levels_proxy(levels_proxy&& other) = default;
+
+    class iterator {
+        friend class levels_proxy;
+
+        levels_proxy* _proxy;
+
+        iterator(levels_proxy* proxy) noexcept :
+            _proxy(proxy)
+        {
+
+        }
+
+    public:
+        using value_type      = std::span<const handle_t>;
+        using difference_type = std::ptrdiff_t;
+        using reference       = value_type;
+
+        iterator() noexcept :
+            _proxy(nullptr)
+        {
+
+        }
+
+        value_type operator*() const noexcept {
+            return _proxy->_current;
+        }
+
+        iterator& operator++() {
+            _proxy->_descend();
+
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return _proxy->_current.empty();
+        }
+    };
+
+    /// @brief Start a traversal of the tree
+    iterator begin() {
+        _current.clear();
+
+        if (auto root = _tree.root()) {
+            _current.push_back(handle_t(root));
+        }
+
+        return iterator(this);
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return std::default_sentinel;
+    }
+};
+
+template<typename T>
+detail::bfs_proxy<T, true> bfs(const unsafe_tree<T>& t) {
+    return { t };
+}
+
+template<typename T>
+detail::bfs_proxy<T, false> bfs(unsafe_tree<T>& t) {
+    return { t };
+}
+
+template<typename T>
+detail::levels_proxy<T, true> levels(const unsafe_tree<T>& t) {
+    return { t };
+}
+
+template<typename T>
+detail::levels_proxy<T, false> levels(unsafe_tree<T>& t) {
+    return { t };
+}
+
 template<order_t O, typename T>
 detail::dfs_proxy<T, O, true> dfs(const unsafe_tree<T>& t) {
     return { t };
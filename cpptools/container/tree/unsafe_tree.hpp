@@ -2,11 +2,12 @@
 #define CPPTOOLS_CONTAINER_TREE_UNSAFE_TREE_HPP
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <stack>
 #include <type_traits>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -15,11 +16,13 @@
 #include <cpptools/exception/parameter_exception.hpp>
 #include <cpptools/exception/iterator_exception.hpp>
 #include <cpptools/utility/attributes.hpp>
-#include <cpptools/utility/heterogenous_lookup.hpp>
+#include <cpptools/utility/concepts.hpp>
+#include <cpptools/utility/hash_combine.hpp>
 #include <cpptools/utility/merge_strategy.hpp>
 #include <cpptools/utility/detail/allocator.hpp>
 
 #include "node.hpp"
+#include "node_pool.hpp"
 
 #ifndef CPPTOOLS_DEBUG_UNSAFE_TREE
 # define CPPTOOLS_DEBUG_UNSAFE_TREE CPPTOOLS_ENABLE_DEBUG_MASTER_SWITCH
@@ -45,79 +48,40 @@ public:
     using node_t            = node<value_type, allocator_type>;
 
 private:
-    using _key_type         = node_t*;
+    using _pool_t           = node_pool<value_type, allocator_type>;
+    using _owner_id         = typename _pool_t::owner_id;
     using _al_node          = rebind_alloc_t<A, node_t>;
     using _al_traits        = std::allocator_traits<_al_node>;
 
-    struct _deleter_t {
-        /// @brief Allocator
-        NO_UNIQUE_ADDR mutable _al_node _alloc;
-
-        void operator()(node_t* node) const {
-            _al_traits::destroy(_alloc, node);
-            _al_traits::deallocate(_alloc, node, 1);
-        }
-
-        _deleter_t() = default;
-        _deleter_t(const _deleter_t &) = default;
-        _deleter_t(_deleter_t &&) = default;
-    };
-
-    using _node_ptr         = std::unique_ptr<node_t, _deleter_t&>;
-
     static constexpr bool _pocca = _al_traits::propagate_on_container_copy_assignment::value;
     static constexpr bool _pocma = _al_traits::propagate_on_container_move_assignment::value;
     static constexpr bool _pocs  = _al_traits::propagate_on_container_swap::value;
 
 public: 
-    using storage_t = std::unordered_set<
-        _node_ptr,
-        unique_ptr_transparent_hash_t<_node_ptr>,
-        unique_ptr_transparent_equality_t<_node_ptr>,
-        rebind_alloc_t<_al_node, _node_ptr>
-    >;
-
     using size_type         = typename _al_traits::size_type;
     using pointer           = typename _al_traits::pointer;
     using const_pointer     = typename _al_traits::const_pointer;
     using difference_type   = typename _al_traits::difference_type;
 
 protected:
-    static constexpr bool NoExceptErasure = noexcept(std::declval<storage_t>().erase(std::declval<_key_type>()));
-    static constexpr bool NoExceptSwap    = noexcept(std::swap(std::declval<storage_t&>(), std::declval<storage_t&>()));
+    static constexpr bool NoExceptErasure = std::is_nothrow_destructible_v<value_type>;
+    static constexpr bool NoExceptSwap    = true;
 
-private:
-    static const_reference _value_const_ref_from_storage_value(const typename storage_t::value_type& ptr) {
-        return ptr->value;
-    }
-
-    static reference _value_ref_from_storage_value(const typename storage_t::value_type& ptr) {
-        return ptr->value;
-    }
-
- public:
-    using const_value_view_t = decltype(std::declval<const storage_t&>() | std::views::transform(_value_const_ref_from_storage_value));
-    using       value_view_t = decltype(std::declval<      storage_t&>() | std::views::transform(_value_ref_from_storage_value));
+public:
+    using const_iterator = typename _pool_t::const_iterator;
+    using       iterator = typename _pool_t::iterator;
 
-    const const_value_view_t& const_values() const {
-        return _const_values;
-    }
+    using const_value_view_t = std::ranges::subrange<const_iterator>;
+    using       value_view_t = std::ranges::subrange<iterator>;
 
-    value_view_t& values() {
-        return _values;
+    const_value_view_t const_values() const {
+        return { begin(), end() };
     }
 
-    const_value_view_t _make_const_value_view() {
-        return static_cast<const storage_t&>(_nodes) | std::views::transform(_value_const_ref_from_storage_value);
+    value_view_t values() {
+        return { begin(), end() };
     }
 
-    value_view_t _make_value_view() {
-        return static_cast<      storage_t&>(_nodes) | std::views::transform(_value_ref_from_storage_value);
-    }
-
-    using const_iterator = decltype(std::declval<const const_value_view_t&>().begin());
-    using       iterator = decltype(std::declval<            value_view_t&>().begin());
-
     struct initializer {
         T value;
         std::vector<initializer> child_initializers;
@@ -130,8 +94,14 @@ private:
     };
 
 private:
-    /// @brief Structure mapping node pointers to their node IDs
-    storage_t _nodes;
+    /// @brief Storage for the nodes, possibly shared with other trees
+    std::shared_ptr<_pool_t> _pool;
+
+    /// @brief ID of this tree in the node pool
+    _owner_id _owner;
+
+    /// @brief Amount of nodes in the tree
+    size_type _size;
 
     /// @brief Pointer to the root node of the tree
     node_t* _root;
@@ -142,16 +112,410 @@ private:
     /// @brief Pointer to the rightmost node of the tree
     node_t* _rightmost;
 
-    /// @brief View over the values of the nodes
-    const_value_view_t _const_values;
-
-    /// @brief View over the const values of the nodes
-    value_view_t _values;
+    /// @brief Incremented on every change to the structure of the tree
+    size_type _revision;
 
     NO_UNIQUE_ADDR _al_node _alloc;
 
-    /// @brief Deleter
-    _deleter_t _deleter;
+    /// @brief Position of a node in an Euler tour of the tree: a node is an
+    /// ancestor of another if and only if its interval strictly contains that
+    /// of the other node
+    struct _interval {
+        size_type enter;
+        size_type exit;
+    };
+
+    using _al_interval = rebind_alloc_t<A, _interval>;
+
+    /// @brief Interval labels of the nodes, indexed by pool slot
+    std::vector<_interval, _al_interval> _labels;
+
+    /// @brief Whether ancestor queries should be answered from the labels
+    bool _indexed;
+
+    /// @brief Whether the labels reflect the current structure of the tree.
+    /// Removing nodes keeps the labels of the remaining ones consistent, only
+    /// adding or moving nodes invalidates them.
+    bool _labels_valid;
+
+    using _al_size = rebind_alloc_t<A, size_type>;
+
+    /// @brief Amount of nodes in the subtree rooted at each node, itself
+    /// included, indexed by pool slot. Only kept up to date while _sized.
+    std::vector<size_type, _al_size> _sizes;
+
+    /// @brief Whether the tree keeps track of the amount of nodes in the
+    /// subtree of each node
+    bool _sized;
+
+    /// @brief Cached hash of a subtree, combining the value of its root with
+    /// the hashes of its children
+    struct _subtree_hash {
+        std::size_t hash;
+        bool        valid;
+    };
+
+    using _al_hash = rebind_alloc_t<A, _subtree_hash>;
+
+    /// @brief Subtree hashes of the nodes, indexed by pool slot. A node whose
+    /// hash is invalid only has ancestors whose hash is invalid too. Entries
+    /// are only ever written by non-const members, so that const queries may
+    /// run concurrently.
+    std::vector<_subtree_hash, _al_hash> _hashes;
+
+    /// @brief Whether subtree hashes are maintained
+    bool _hashed;
+
+    /// @brief Amount of batches currently open on this tree, see begin_batch
+    size_type _batch_depth;
+
+    /// @brief Amount of children removed within the current batch, whose
+    /// entries were left empty in their parent
+    size_type _vacated;
+
+    /// @brief Get the node pool of this tree, creating it if needed
+    _pool_t& _storage() {
+        if (!_pool) {
+            _pool  = std::allocate_shared<_pool_t>(_alloc, get_allocator());
+            _owner = _pool->make_owner();
+        }
+
+        return *_pool;
+    }
+
+    /// @brief Stop using the node pool of this tree, reporting it to the pool
+    /// so that it stops locking once a single tree uses it
+    void _release_pool() noexcept {
+        if (_pool) {
+            _pool->release_owner();
+            _pool.reset();
+        }
+    }
+
+    /// @brief Tell whether a node belongs to this tree
+    bool _owns(const node_t* n) const noexcept {
+        return _pool && _pool->owns(n, _owner);
+    }
+
+    /// @brief Forget about all nodes without destroying them, for use after
+    /// they have been handed over to another tree
+    void _reset() noexcept {
+        _release_pool();
+        _size         = 0;
+        _root         = nullptr;
+        _leftmost     = nullptr;
+        _rightmost    = nullptr;
+        _labels_valid = false;
+        ++_revision;
+    }
+
+    /// @brief Take over the nodes and ancestor index of another tree, which
+    /// must have been cleared beforehand
+    void _steal_contents(unsafe_tree& other) noexcept {
+        _release_pool();
+        _pool         = std::move(other._pool);
+        _owner        = other._owner;
+        _size         = other._size;
+        _root         = other._root;
+        _leftmost     = other._leftmost;
+        _rightmost    = other._rightmost;
+        _labels       = std::move(other._labels);
+        _indexed      = other._indexed;
+        _labels_valid = other._labels_valid;
+        _sizes        = std::move(other._sizes);
+        _sized        = other._sized;
+        _hashes       = std::move(other._hashes);
+        _hashed       = other._hashed;
+        ++_revision;
+
+        other._reset();
+    }
+
+    /// @brief Label all nodes of the tree with their Euler tour interval
+    void _rebuild_labels() {
+        _labels.resize(_pool ? _pool->capacity() : 0);
+
+        size_type clock = 0;
+        const node_t* n = _root;
+        while (n != nullptr) {
+            _labels[_pool_t::slot_of(n)].enter = clock++;
+
+            if (n->child_count() != 0) {
+                n = n->child(0);
+                continue;
+            }
+
+            // close the leaf, then every ancestor it was the last node of
+            while (true) {
+                _labels[_pool_t::slot_of(n)].exit = clock++;
+
+                if (n == _root) {
+                    n = nullptr;
+                    break;
+                }
+
+                if (!n->is_rightmost_sibling()) {
+                    n = n->right_sibling();
+                    break;
+                }
+
+                n = n->parent();
+            }
+        }
+
+        _labels_valid = true;
+    }
+
+    /// @brief Tell whether a node is a strict descendant of another, from the
+    /// labels if they are up to date, walking up the tree otherwise
+    /// @note This never rebuilds the labels, so that mutations interleaved
+    /// with extremum checks do not each pay for a full traversal.
+    bool _has_parent(const node_t* n, const node_t* ancestor) const CPPTOOLS_NOEXCEPT_RELEASE {
+        if (_indexed && _labels_valid) {
+            const _interval& inner = _labels[_pool_t::slot_of(n)];
+            const _interval& outer = _labels[_pool_t::slot_of(ancestor)];
+
+            return outer.enter < inner.enter && inner.exit < outer.exit;
+        }
+
+        return n->has_parent(ancestor);
+    }
+
+    /// @brief Account for nodes added below a node or removed from below it,
+    /// in the subtree sizes of that node and its ancestors
+    /// @param n Node below which nodes were added or removed
+    /// @param delta Amount of nodes added, negative if nodes were removed
+    void _resize_path(node_t* n, difference_type delta) noexcept {
+        if (!_sized) {
+            return;
+        }
+
+        for (; n != nullptr; n = n->parent()) {
+            _sizes[_pool_t::slot_of(n)] += static_cast<size_type>(delta);
+        }
+    }
+
+    /// @brief Get the amount of nodes in the subtree rooted at a node, itself
+    /// included, or 0 if subtree sizes are not kept track of
+    size_type _subtree_size(const node_t* n) const noexcept {
+        return _sized ? _sizes[_pool_t::slot_of(n)] : 0;
+    }
+
+    /// @brief Compute the subtree size of all nodes of a subtree from scratch
+    /// @param subtree_root Root of the subtree whose nodes to update, whose
+    /// slots may not be covered by the sizes yet
+    void _size_subtree(const node_t* subtree_root) {
+        if (_sizes.size() < _pool->capacity()) {
+            _sizes.resize(_pool->capacity());
+        }
+
+        // stackless post-order traversal: children are sized before their parent
+        node_t* n = const_cast<node_t*>(subtree_root)->leftmost_child_or_this();
+        while (true) {
+            size_type size = 1;
+            for (const node_t* child : n->children()) {
+                size += _sizes[_pool_t::slot_of(child)];
+            }
+            _sizes[_pool_t::slot_of(n)] = size;
+
+            if (n == subtree_root) {
+                break;
+            }
+
+            n = n->is_rightmost_sibling()
+                ? n->parent()
+                : n->right_sibling()->leftmost_child_or_this();
+        }
+    }
+
+    /// @brief Get the node at some position in a pre-order traversal of a
+    /// subtree whose nodes keep track of their subtree size
+    /// @param n Root of the subtree to look into
+    /// @param index Position of the node to find, relative to \c n
+    template<any_cvref<node_t> Node>
+    Node* _nth_in_subtree(Node* n, size_type index) const noexcept {
+        while (index != 0) {
+            --index;
+
+            for (Node* child : n->children()) {
+                const size_type size = _sizes[_pool_t::slot_of(child)];
+                if (index < size) {
+                    n = child;
+                    break;
+                }
+
+                index -= size;
+            }
+        }
+
+        return n;
+    }
+
+    /// @brief Invalidate the subtree hash of a node and of all its ancestors
+    void _invalidate_hashes(const node_t* n) noexcept {
+        if (!_hashed) {
+            return;
+        }
+
+        // ancestors of an invalid node are already invalid
+        for (; n != nullptr; n = n->parent()) {
+            _subtree_hash& entry = _hashes[_pool_t::slot_of(n)];
+            if (!entry.valid) {
+                break;
+            }
+
+            entry.valid = false;
+        }
+    }
+
+    /// @brief Invalidate the subtree hash of all nodes of a subtree, whose
+    /// entries may belong to another tree
+    void _invalidate_subtree_hashes(const node_t* subtree_root) {
+        if (!_hashed) {
+            return;
+        }
+
+        _hashes.resize(_pool->capacity());
+        for (const node_t* n = subtree_root; n != nullptr; n = _next_in_subtree(subtree_root, n)) {
+            _hashes[_pool_t::slot_of(n)].valid = false;
+        }
+    }
+
+    /// @brief Compute the hash of a subtree, only visiting the nodes whose
+    /// hash is not up to date
+    /// @param subtree_root Root of the subtree to hash
+    /// @param store Cache to write the recomputed hashes to, or null to leave
+    /// the cache untouched
+    std::size_t _hash_of(const node_t* subtree_root, std::vector<_subtree_hash, _al_hash>* store) const {
+        // a stale node, the hash accumulated so far and its next child to visit
+        struct frame {
+            const node_t* n;
+            std::size_t   hash;
+            size_type     next_child;
+        };
+
+        auto start = [](const node_t* n) {
+            std::size_t hash = std::hash<T>{}(n->value());
+            hash_combine(hash, n->child_count());
+            return frame{ n, hash, 0 };
+        };
+
+        const _subtree_hash& root_entry = _hashes[_pool_t::slot_of(subtree_root)];
+        if (root_entry.valid) {
+            return root_entry.hash;
+        }
+
+        std::vector<frame> pending = { start(subtree_root) };
+        while (true) {
+            frame& top = pending.back();
+            if (top.next_child == top.n->child_count()) {
+                // all children hashed, hand the result over to the parent
+                const frame done = top;
+                pending.pop_back();
+                if (store != nullptr) {
+                    (*store)[_pool_t::slot_of(done.n)] = { done.hash, true };
+                }
+
+                if (pending.empty()) {
+                    return done.hash;
+                }
+
+                hash_combine(pending.back().hash, done.hash);
+                continue;
+            }
+
+            const node_t* child = top.n->child(top.next_child++);
+            const _subtree_hash& entry = _hashes[_pool_t::slot_of(child)];
+            if (entry.valid) {
+                hash_combine(top.hash, entry.hash);
+            } else {
+                pending.push_back(start(child));
+            }
+        }
+    }
+
+    /// @brief Tell whether a node is an extremum node of the tree or one of
+    /// its ancestors
+    bool _holds(const node_t* subtree_root, const node_t* extremum) const CPPTOOLS_NOEXCEPT_RELEASE {
+        return subtree_root == extremum || _has_parent(extremum, subtree_root);
+    }
+
+    /// @brief Get the node following another one in a pre-order traversal of
+    /// a subtree
+    /// @param subtree_root Root of the subtree being traversed
+    /// @param n Node from which to find the next one
+    /// @return The next node, or null if \c n was the last node of the subtree
+    template<any_cvref<node_t> Node>
+    static Node* _next_in_subtree(const node_t* subtree_root, Node* n) CPPTOOLS_NOEXCEPT_RELEASE {
+        if (n->child_count() != 0) {
+            return n->child(0);
+        }
+
+        while (n != subtree_root && n->is_rightmost_sibling()) {
+            n = n->parent();
+        }
+
+        return (n == subtree_root)
+            ? nullptr
+            : n->right_sibling();
+    }
+
+    /// @brief Drop the entries left empty by children removed within a batch
+    /// from all nodes of a subtree, renumbering their children
+    /// @param subtree_root Root of the subtree to compact
+    void _compact_subtree(node_t* subtree_root) noexcept {
+        // stackless pre-order traversal: the children of a node, and those of
+        // all its ancestors, are compacted before its siblings are looked up
+        for (node_t* n = subtree_root; n != nullptr; n = _next_in_subtree(subtree_root, n)) {
+            n->compact_children();
+        }
+    }
+
+    /// @brief Erase a subtree within a batch, leaving its entry in its parent
+    /// empty and its extremum nodes and subtree sizes for the commit to fix
+    void _erase_in_batch(node_t* subtree_root) CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptErasure) {
+        node_t* parent = subtree_root->parent();
+        parent->vacate_child(subtree_root->sibling_index());
+        _invalidate_hashes(parent);
+
+        // nodes are deleted through a traversal of the subtree, which must not
+        // run into empty entries
+        if (_vacated != 0) {
+            _compact_subtree(subtree_root);
+        }
+        ++_vacated;
+
+        _delete_subtree_nodes(subtree_root);
+    }
+
+    /// @brief Move a subtree within a batch, leaving its entry in its former
+    /// parent empty and its extremum nodes and subtree sizes for the commit to
+    /// fix
+    void _move_in_batch(node_t* destination, node_t* subtree_root) {
+        node_t* parent = subtree_root->parent();
+        parent->vacate_child(subtree_root->sibling_index());
+        ++_vacated;
+        _invalidate_hashes(parent);
+
+        destination->insert_child(subtree_root);
+        _invalidate_hashes(destination);
+        ++_revision;
+        _labels_valid = false;
+    }
+
+    /// @brief Hand all nodes of a subtree over to another owner of the pool
+    /// @param subtree_root Root of the subtree whose nodes should be handed over
+    /// @param owner ID of the new owner
+    /// @return The amount of nodes which were handed over
+    size_type _retag_subtree(node_t* subtree_root, _owner_id owner) noexcept {
+        size_type count = 0;
+        for (node_t* n = subtree_root; n != nullptr; n = _next_in_subtree(subtree_root, n)) {
+            _pool->set_owner(n, owner);
+            ++count;
+        }
+
+        return count;
+    }
 
     void _copy_fill_from_init(node_t* dest, const std::vector<initializer>& child_initializers) {
         for (const auto& init : child_initializers) {
@@ -173,57 +537,177 @@ private:
         }
     }
 
-    /// @brief Transfer ownership of nodes of a subtree from this tree's storage
-    /// to another storage
-    /// @param subtree_root Root of the subtree whose nodes should be transferred
-    /// @param storage Storage where the nodes should be transferred to
-    void _move_node_ptrs_recursive(node_t* subtree_root, storage_t& storage) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, subtree_root), "unsafe_tree", critical, "cannot move nodes not part of tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+    /// @brief Given another tree, use its nodes to copy-construct this tree's
+    /// nodes, replicating its structure
+    /// @param copy_from Root of the subtree to copy
+    /// @param count Amount of nodes in the subtree if known, 0 otherwise
+    void _copy_assign_contents(const node_t *copy_from, size_type count = 0) {
+        clear();
 
-        auto map_node = _nodes.extract(subtree_root);
-        storage.insert(std::move(map_node));
+        if (copy_from != nullptr) {
+            _storage().reserve(count);
 
-        for (auto child : subtree_root->children()) {
-            _move_node_ptrs_recursive(child, storage);
+            _root      = _replicate_subtree<false>(copy_from);
+            _leftmost  = _root->leftmost_child_or_this();
+            _rightmost = _root->rightmost_child_or_this();
         }
     }
 
-    /// @brief Given a source root node and a destination root node, recursively
-    /// copy all source children nodes as children of the destination node
-    /// @param from Node whose chidlren should be copied
-    /// @param to Node which should adopt the copied nodes
-    void _copy_children_recursive(const node_t* from, node_t* to) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, to), "unsafe_tree", critical, "destination not in tree",               exception::parameter::invalid_value_error, "to", to);
-        CPPTOOLS_DEBUG_ASSERT(!to->has_parent(from),     "unsafe_tree", critical, "destination is part of copied subtree", exception::parameter::invalid_value_error, "to", to);
+    /// @brief Make this tree a copy of another, reusing the nodes of this
+    /// tree wherever both trees have the same structure
+    /// @param other Tree to copy contents from
+    /// @note Values of matching nodes are copy-assigned in place: assigning a
+    /// tree with the same shape performs no allocation. Only the nodes which
+    /// are in excess in either tree are deleted or created.
+    /// @exception Any exception thrown in the assignment operator or a
+    /// constructor of the value type will be forwarded to the caller. The tree
+    /// is left in a valid but unspecified state.
+    void _reuse_assign_contents(const unsafe_tree& other) {
+        if (other._root == nullptr) {
+            clear();
+            return;
+        }
+
+        if (_root == nullptr) {
+            _copy_assign_contents(other._root, other._size);
+            return;
+        }
+
+        try {
+            node_t*       dest   = _root;
+            const node_t* source = other._root;
+
+            // stackless pre-order traversal of both trees in lockstep, only
+            // descending into children which exist on both sides
+            while (true) {
+                dest->value() = source->value();
+                _trim_children(dest, source->child_count());
 
-        for (auto child : from->children()) {
-            // make new child node holding a copy of the source value
-            node_t* copied = make_node(child->value);
+                if (dest->child_count() != 0) {
+                    dest   = dest->child(0);
+                    source = source->child(0);
+                    continue;
+                }
+
+                _append_replicas(dest, source, 0);
 
-            // insert copied child into destination
-            to->insert_child(copied);
+                while (dest != _root && dest->is_rightmost_sibling()) {
+                    // the source node may have more siblings than the destination
+                    _append_replicas(dest->parent(), source->parent(), source->sibling_index() + 1);
+
+                    dest   = dest->parent();
+                    source = source->parent();
+                }
 
-            // recurse copy
-            if (child->child_count() > 0) {
-                _copy_children_recursive(child, copied);
+                if (dest == _root) {
+                    break;
+                }
+
+                dest   = dest->right_sibling();
+                source = source->right_sibling();
             }
+        } catch (...) {
+            _leftmost  = _root->leftmost_child_or_this();
+            _rightmost = _root->rightmost_child_or_this();
+            _invalidate_subtree_hashes(_root);
+            throw;
         }
+
+        _leftmost  = _root->leftmost_child_or_this();
+        _rightmost = _root->rightmost_child_or_this();
+        _invalidate_subtree_hashes(_root);
     }
 
-    /// @brief Given another tree, use its nodes to copy-construct this tree's
-    /// nodes, replicating its structure
-    void _copy_assign_contents(const node_t *copy_from) {
-        clear();
+    /// @brief Delete the rightmost children of a node until it has no more
+    /// than a given amount of children
+    void _trim_children(node_t* n, size_type count) CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptErasure) {
+        while (n->child_count() > count) {
+            node_t* removed = n->remove_child(n->child_count() - 1);
+            _resize_path(n, -static_cast<difference_type>(_subtree_size(removed)));
+            _delete_subtree_nodes(removed);
+        }
+    }
 
-        if (copy_from != nullptr) {
-            _root = make_node(copy_from->value);
-            if (copy_from->child_count() > 0) {
-                _copy_children_recursive(copy_from, _root);
+    /// @brief Append copies of the children of a source node to a node of
+    /// this tree
+    /// @param dest Node to append copies to
+    /// @param source Node whose children should be copied
+    /// @param first Index of the first child of \c source to be copied
+    void _append_replicas(node_t* dest, const node_t* source, size_type first) {
+        const size_type count = source->child_count();
+        if (first == count) {
+            return;
+        }
+
+        dest->reserve(dest->child_count() + (count - first));
+        for (size_type i = first; i < count; ++i) {
+            node_t* replica = _replicate_subtree<false>(source->child(i));
+            dest->insert_child(replica);
+            _resize_path(dest, _subtree_size(replica));
+        }
+    }
+
+    /// @brief Replicate a subtree of another tree into this tree's storage
+    /// @tparam Move Whether values should be moved out of the source nodes
+    /// rather than copied
+    /// @param from Root of the subtree to replicate
+    /// @return A pointer to the root of the replica, which is left orphaned.
+    /// Its nodes keep track of their subtree size if this tree does.
+    /// @exception Any exception thrown in a constructor of the value type
+    /// will be forwarded to the caller, after the partial replica was deleted
+    template<bool Move>
+    node_t* _replicate_subtree(std::conditional_t<Move, node_t, const node_t>* from) {
+        auto transfer = [](auto* n) -> decltype(auto) {
+            if constexpr (Move) {
+                return std::move(n->value());
+            } else {
+                return std::as_const(n->value());
             }
+        };
+
+        auto source = from;
+        node_t* dest = make_node(transfer(source));
+        dest->reserve(source->child_count());
+
+        node_t* dest_root = dest;
+
+        try {
+            // stackless pre-order traversal of the source subtree, the
+            // destination cursor follows along
+            while (true) {
+                node_t* dest_parent;
+
+                if (source->child_count() != 0) {
+                    dest_parent = dest;
+                    source      = source->child(0);
+                } else {
+                    while (source != from && source->is_rightmost_sibling()) {
+                        source = source->parent();
+                        dest   = dest->parent();
+                    }
+
+                    if (source == from) {
+                        break;
+                    }
+
+                    dest_parent = dest->parent();
+                    source      = source->right_sibling();
+                }
 
-            _leftmost = _root->leftmost_child_or_this();
-            _rightmost = _root->rightmost_child_or_this();
+                dest = make_node(transfer(source));
+                dest->reserve(source->child_count());
+                dest_parent->insert_child(dest);
+            }
+        } catch (...) {
+            _delete_subtree_nodes(dest_root);
+            throw;
         }
+
+        if (_sized) {
+            _size_subtree(dest_root);
+        }
+
+        return dest_root;
     }
 
     /// @brief Given another tree, use its nodes to move-construct this tree's
@@ -233,89 +717,55 @@ private:
     /// nodes. This is useful when the tree being moved-from uses a different
     /// allocator.
     void _move_assign_contents(unsafe_tree &&other) {
-        using node_pair = std::pair<node_t *, node_t *>;
-
-        // move-construct reallocated root node
-        node_t* this_node = make_node(std::move(other._root->value));
-        node_t* other_node = other._root;
-
-        _root = this_node;
+        clear();
 
-        auto root_child_count = other_node->child_count();
-        if (root_child_count == 0) {
-            _leftmost  = _root;
-            _rightmost = _root;
+        if (other._root != nullptr) {
+            _storage().reserve(other._size);
 
-            other._nodes.clear();
-            return;
+            _root      = _replicate_subtree<true>(other._root);
+            _leftmost  = _root->leftmost_child_or_this();
+            _rightmost = _root->rightmost_child_or_this();
         }
 
-        // iterative pre-order DFS traversal to move-construct reallocated nodes
-        // and replicate node structure
-        this_node->reserve(other_node->child_count());
-
-        std::stack<node_pair, std::vector<node_pair>> node_stack;
-        node_stack.push({this_node, other_node});
-
-        node_t* parent_node = this_node;
-        other_node = other_node->child(0);
-        do {
-            // move-construct node
-            this_node = make_node(std::move(other_node->value));
-            this_node->reserve(other_node->child_count());
-
-            parent_node->insert_child(this_node);
-            parent_node = this_node;
-
-            // find next node
-            if (other_node->child_count() != 0) {
-                // visit leftmost children first
-                node_stack.push({this_node, other_node});
-
-                this_node  = this_node->child(0);
-                other_node = other_node->child(0);
-            } else {
-                // unstack to a non-rightmost node
-                while (!node_stack.empty() && this_node->parent() != nullptr && this_node->is_rightmost_sibling()) {
-                    std::tie(this_node, other_node) = node_stack.top();
-                    node_stack.pop();
-                }
-                // stack exhausted == tree fully visited
-                // stack not exhausted (== non-null parents) == more right branches to visit
-                if (!node_stack.empty()) {
-                    // visit right siblings
-                    this_node  = this_node->right_sibling();
-                    other_node = other_node->right_sibling();
-                }
-            }
-        } while (!node_stack.empty());
-
-        _leftmost  = _root->child(0)->leftmost_child_or_this();
-        _rightmost = _root->child(root_child_count)->rightmost_child_or_this();
-
-        other._nodes.clear();
+        other.clear();
     }
 
     /// @brief Delete an entire subtree from the node storage, including the
     /// values held by its nodes.
     /// @param branch_root Root of the subtree whose nodes must be deleted
     void _delete_subtree_nodes(node_t* subtree_root) CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptErasure) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, subtree_root), "unsafe_tree", critical, "subtree root not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
-
-        for (auto child : subtree_root->release_children()) {
-            _delete_subtree_nodes(child);
+        CPPTOOLS_DEBUG_ASSERT(_owns(subtree_root), "unsafe_tree", critical, "subtree root not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+
+        // stackless post-order traversal: a node is only destroyed once the
+        // next node was found, and the next node never lies below it
+        node_t* n = subtree_root->leftmost_child_or_this();
+        while (n != subtree_root) {
+            node_t* next = n->is_rightmost_sibling()
+                ? n->parent()
+                : n->right_sibling()->leftmost_child_or_this();
+
+            _destroy_node(n);
+            n = next;
         }
 
-        _delete_node(subtree_root);
+        _destroy_node(subtree_root);
     }
 
     /// @brief Delete a node and the value it holds
     /// @param n Node to be deleted
     void _delete_node(node_t* n) CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptErasure) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, n), "unsafe_tree", critical, "node not in tree",                           exception::parameter::invalid_value_error,"n", n);
-        CPPTOOLS_DEBUG_ASSERT(n->children().empty(),    "unsafe_tree", critical, "node to be deleted shall not have children", exception::parameter::invalid_value_error,"n", n);
+        CPPTOOLS_DEBUG_ASSERT(_owns(n),              "unsafe_tree", critical, "node not in tree",                           exception::parameter::invalid_value_error,"n", n);
+        CPPTOOLS_DEBUG_ASSERT(n->children().empty(), "unsafe_tree", critical, "node to be deleted shall not have children", exception::parameter::invalid_value_error,"n", n);
 
-        _nodes.erase(n);
+        _destroy_node(n);
+    }
+
+    /// @brief Give the slot of a node back to the pool, regardless of its
+    /// children
+    void _destroy_node(node_t* n) noexcept(NoExceptErasure) {
+        _pool->destroy(n);
+        --_size;
+        ++_revision;
     }
 
     /// @brief Compare whether two subtrees are equal both in structure and value
@@ -344,7 +794,7 @@ private:
             }
 
             // compare value
-            if (this_node->value != other_node->value) {
+            if (this_node->value() != other_node->value()) {
                 return false;
             }
 
@@ -374,33 +824,54 @@ private:
     }
 
     /// @brief Construct a tree from a detached subtree
-    /// @param chopped_nodes Storage to steal nodes from
+    /// @param pool Pool holding the nodes of the subtree
+    /// @param owner ID of the chopped subtree in the pool
+    /// @param size Amount of nodes in the chopped subtree
     /// @param chopped_root Root node of this tree
     /// @param chopped_leftmost Leftmost node of this tree
     /// @param chopped_rightmost Rightmost node of this tree
-    unsafe_tree(storage_t&& chopped_nodes, node_t* chopped_root, node_t* chopped_leftmost, node_t* chopped_rightmost) :
-        _nodes(std::move(chopped_nodes)),
+    /// @param alloc Allocator of the tree the subtree was chopped from
+    unsafe_tree(std::shared_ptr<_pool_t> pool, _owner_id owner, size_type size, node_t* chopped_root, node_t* chopped_leftmost, node_t* chopped_rightmost, const _al_node& alloc) :
+        _pool(std::move(pool)),
+        _owner(owner),
+        _size(size),
         _root(chopped_root),
         _leftmost(chopped_leftmost),
         _rightmost(chopped_rightmost),
-        _const_values(_make_const_value_view()),
-        _values(_make_value_view()),
-        _alloc(),
-        _deleter()
+        _revision(0),
+        _alloc(alloc),
+        _labels(_al_interval(_alloc)),
+        _indexed(false),
+        _labels_valid(false),
+        _sizes(_al_size(_alloc)),
+        _sized(false),
+        _hashes(_al_hash(_alloc)),
+        _hashed(false),
+        _batch_depth(0),
+        _vacated(0)
     {
         _root->clear_parent_metadata();
     }
 
 public:
     unsafe_tree(allocator_type alloc = {}) :
-        _nodes(),
+        _pool(),
+        _owner(),
+        _size(0),
         _root(nullptr),
         _leftmost(nullptr),
         _rightmost(nullptr),
-        _const_values(_make_const_value_view()),
-        _values(_make_value_view()),
+        _revision(0),
         _alloc(std::move(alloc)),
-        _deleter()
+        _labels(_al_interval(_alloc)),
+        _indexed(false),
+        _labels_valid(false),
+        _sizes(_al_size(_alloc)),
+        _sized(false),
+        _hashes(_al_hash(_alloc)),
+        _hashed(false),
+        _batch_depth(0),
+        _vacated(0)
     {
 
     }
@@ -419,51 +890,47 @@ public:
     /// @exception Any exception thrown in a constructor of the value type
     /// will be forwarded to the caller
     unsafe_tree(const unsafe_tree& other, allocator_type alloc = {}) :
-        unsafe_tree(other._root, alloc)
+        unsafe_tree(alloc)
     {
+        _copy_assign_contents(other._root, other._size);
     }
 
     /// @param other Tree to move-construct from
     unsafe_tree(unsafe_tree&& other) :
-        _nodes(std::move(other._nodes)),
+        _pool(std::move(other._pool)),
+        _owner(other._owner),
+        _size(other._size),
         _root(other._root),
         _leftmost(other._leftmost),
         _rightmost(other._rightmost),
-        _const_values(_make_const_value_view()),
-        _values(_make_value_view()),
+        _revision(0),
         _alloc(std::move(other._alloc)),
-        _deleter()
+        _labels(std::move(other._labels)),
+        _indexed(other._indexed),
+        _labels_valid(other._labels_valid),
+        _sizes(std::move(other._sizes)),
+        _sized(other._sized),
+        _hashes(std::move(other._hashes)),
+        _hashed(other._hashed),
+        _batch_depth(0),
+        _vacated(0)
     {
-        other._root = nullptr;
-        other._leftmost = nullptr;
-        other._rightmost = nullptr;
+        other._reset();
     }
 
     /// @param other Tree to move-construct from
     unsafe_tree(unsafe_tree&& other, allocator_type alloc) :
-        _nodes(),
-        _root(nullptr),
-        _leftmost(nullptr),
-        _rightmost(nullptr),
-        _const_values(_make_const_value_view()),
-        _values(_make_value_view()),
-        _alloc(std::move(alloc)),
-        _deleter()
+        unsafe_tree(std::move(alloc))
     {
-        if (other._alloc != alloc) {
-            if (!other.empty()) {
-                _move_assign_contents(std::move(other));
-            }
+        if (other._alloc != _alloc) {
+            _move_assign_contents(std::move(other));
         } else {
-            _nodes = std::move(other._nodes);
-            _root = other._root;
-            _leftmost = other._leftmost;
-            _rightmost = other._rightmost;
+            _steal_contents(other);
         }
+    }
 
-        other._root = nullptr;
-        other._leftmost = nullptr;
-        other._rightmost = nullptr;
+    ~unsafe_tree() {
+        clear();
     }
 
     unsafe_tree(const initializer& init) :
@@ -480,34 +947,200 @@ public:
         _move_fill_from_init(emplaced_root, std::move(init.child_initializers));
     }
 
+    /// @brief Parent index marking the root node in a parent array
+    static constexpr size_type no_parent = std::numeric_limits<size_type>::max();
+
+    /// @brief Build a tree out of an array of parent indices
+    /// @param values Values of the nodes
+    /// @param parents Index of the parent of each node in \c values, or
+    /// \c no_parent for the root node. Children of a node are ordered by
+    /// index.
+    /// @param alloc Allocator of the new tree
+    /// @return The tree described by the arrays
+    /// @exception exception::parameter::invalid_value_error if the arrays do
+    /// not have the same size or do not describe exactly one tree
+    /// @exception Any exception thrown in a constructor of the value type
+    /// will be forwarded to the caller
+    /// @note Runs in linear time. All storage is sized once, so that the only
+    /// allocations are those of the node pool and of one child vector per
+    /// inner node.
+    static unsafe_tree from_parent_array(std::span<const T> values, std::span<const size_type> parents, allocator_type alloc = {}) {
+        const size_type count = values.size();
+        if (parents.size() != count) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "parents", parents.size()).with_message("parent array and value array differ in size");
+        }
+
+        unsafe_tree result(std::move(alloc));
+        if (count == 0) {
+            return result;
+        }
+
+        std::vector<size_type> child_counts(count, 0);
+        size_type root_index = no_parent;
+        for (size_type i = 0; i < count; ++i) {
+            if (parents[i] == no_parent) {
+                if (root_index != no_parent) {
+                    CPPTOOLS_THROW(exception::parameter::invalid_value_error, "parents", i).with_message("parent array describes more than one root");
+                }
+                root_index = i;
+            } else if (parents[i] >= count || parents[i] == i) {
+                CPPTOOLS_THROW(exception::parameter::invalid_value_error, "parents", i).with_message("parent index out of bounds");
+            } else {
+                ++child_counts[parents[i]];
+            }
+        }
+
+        if (root_index == no_parent) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "parents", count).with_message("parent array describes no root");
+        }
+
+        result._storage().reserve(count);
+
+        std::vector<node_t*> nodes(count);
+        for (size_type i = 0; i < count; ++i) {
+            nodes[i] = result.make_node(values[i]);
+            nodes[i]->reserve(child_counts[i]);
+        }
+
+        for (size_type i = 0; i < count; ++i) {
+            if (i != root_index) {
+                nodes[parents[i]]->insert_child(nodes[i]);
+            }
+        }
+
+        result._root = nodes[root_index];
+
+        // nodes caught in a cycle are unreachable from the root
+        size_type reachable = 0;
+        for (const node_t* n = result._root; n != nullptr; n = _next_in_subtree(result._root, n)) {
+            ++reachable;
+        }
+
+        if (reachable != count) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "parents", count - reachable).with_message("parent array contains cycles");
+        }
+
+        result._leftmost  = result._root->leftmost_child_or_this();
+        result._rightmost = result._root->rightmost_child_or_this();
+
+        return result;
+    }
+
+    /// @brief Build a tree out of the values of its nodes in pre-order, along
+    /// with their amount of children
+    /// @param values Values of the nodes, in pre-order
+    /// @param child_counts Amount of children of each node in \c values
+    /// @param alloc Allocator of the new tree
+    /// @return The tree described by the arrays
+    /// @exception exception::parameter::invalid_value_error if the arrays do
+    /// not have the same size or do not describe exactly one tree
+    /// @exception Any exception thrown in a constructor of the value type
+    /// will be forwarded to the caller
+    /// @note Runs in linear time. All storage is sized once, so that the only
+    /// allocations are those of the node pool, of one child vector per inner
+    /// node and of a stack as deep as the tree.
+    static unsafe_tree from_preorder(std::span<const T> values, std::span<const size_type> child_counts, allocator_type alloc = {}) {
+        const size_type count = values.size();
+        if (child_counts.size() != count) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "child_counts", child_counts.size()).with_message("child count array and value array differ in size");
+        }
+
+        unsafe_tree result(std::move(alloc));
+        if (count == 0) {
+            return result;
+        }
+
+        result._storage().reserve(count);
+
+        // nodes which are still missing children, and how many they miss
+        std::vector<std::pair<node_t*, size_type>> open;
+
+        for (size_type i = 0; i < count; ++i) {
+            if (i != 0 && open.empty()) {
+                CPPTOOLS_THROW(exception::parameter::invalid_value_error, "child_counts", i).with_message("child counts describe more than one tree");
+            }
+
+            // every child is one of the nodes still to come: checked before
+            // reserving, so that a malformed count cannot cause a huge allocation
+            if (child_counts[i] > count - 1 - i) {
+                CPPTOOLS_THROW(exception::parameter::invalid_value_error, "child_counts", child_counts[i]).with_message("child counts describe more nodes than there are values");
+            }
+
+            node_t* n = result.make_node(values[i]);
+            n->reserve(child_counts[i]);
+
+            if (open.empty()) {
+                result._root = n;
+            } else {
+                open.back().first->insert_child(n);
+                --open.back().second;
+            }
+
+            if (child_counts[i] != 0) {
+                open.emplace_back(n, child_counts[i]);
+            }
+
+            while (!open.empty() && open.back().second == 0) {
+                open.pop_back();
+            }
+        }
+
+        if (!open.empty()) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "child_counts", open.size()).with_message("child counts describe more nodes than there are values");
+        }
+
+        result._leftmost  = result._root->leftmost_child_or_this();
+        result._rightmost = result._root->rightmost_child_or_this();
+
+        return result;
+    }
+
     /// @param other Tree to copy-assign contents from
     unsafe_tree& operator=(const unsafe_tree& other) {
+        if (&other == this) {
+            return *this;
+        }
+
         if constexpr (_pocca) {
-            _alloc = other._alloc;
+            if (_alloc != other._alloc) {
+                // nodes cannot be reused across allocators, and neither can
+                // the pool and side data, which hold the previous allocator
+                clear();
+                _release_pool();
+                _alloc  = other._alloc;
+                _labels = decltype(_labels)(_al_interval(_alloc));
+                _sizes  = decltype(_sizes)(_al_size(_alloc));
+                _hashes = decltype(_hashes)(_al_hash(_alloc));
+            }
         }
-        _copy_assign_contents(other._root);
+        _reuse_assign_contents(other);
 
         return *this;
     }
 
     /// @param other Tree to move-assign contents from
     unsafe_tree& operator=(unsafe_tree&& other) {
+        if (&other == this) {
+            return *this;
+        }
+
         bool steal = (_alloc == other._alloc);
 
         if constexpr (_pocma) {
-            _alloc = std::move(other._alloc);
             steal = true;
         }
 
         if (steal) {
-            _nodes = std::move(other._nodes);
-            _root = other._root;
-            _leftmost = other._leftmost;
-            _rightmost = other._rightmost;
+            clear();
+
+            if constexpr (_pocma) {
+                _alloc = std::move(other._alloc);
+            }
+
+            _steal_contents(other);
         } else {
             _move_assign_contents(std::move(other));
         }
-        other.clear();
 
         return *this;
     }
@@ -535,11 +1168,26 @@ public:
     /// @return A pointer to the newly created node
     template<typename... ArgTypes>
     [[nodiscard]] node_t* make_node(ArgTypes&&... args) {
-        node_t *raw_ptr = _al_traits::allocate(_alloc, 1);
-        _al_traits::construct(_alloc, raw_ptr, std::forward<ArgTypes>(args)...);
+        node_t* n = _storage().create(_owner, std::forward<ArgTypes>(args)...);
+        if (_sized) {
+            const size_type slot = _pool_t::slot_of(n);
+            if (slot >= _sizes.size()) {
+                _sizes.resize(_pool->capacity());
+            }
+            _sizes[slot] = 1;
+        }
+        if (_hashed) {
+            const size_type slot = _pool_t::slot_of(n);
+            if (slot >= _hashes.size()) {
+                _hashes.resize(_pool->capacity());
+            }
+            _hashes[slot].valid = false;
+        }
+        ++_size;
+        ++_revision;
+        _labels_valid = false;
 
-        _nodes.insert(_node_ptr(raw_ptr, _deleter));
-        return raw_ptr;
+        return n;
     }
 
     /// @brief Tells whether emplacing a node somewhere would change the 
@@ -549,7 +1197,7 @@ public:
     /// @return Whether emplacing a node as a new child to \c dest_node would 
     /// change the leftmost node of the tree
     bool emplacing_there_would_change_leftmost(node_t* where) const CPPTOOLS_NOEXCEPT_RELEASE {
-        CPPTOOLS_DEBUG_ASSERT(both_null(where, _root) || in_range_keys(_nodes, where), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "where", where);
+        CPPTOOLS_DEBUG_ASSERT(both_null(where, _root) || _owns(where), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "where", where);
 
         return where == _leftmost;
     }
@@ -561,24 +1209,30 @@ public:
     /// @return Whether emplacing a node as a new child to \c dest_node would 
     /// change the rightmost node of the tree
     bool emplacing_there_would_change_rightmost(node_t* where) const CPPTOOLS_NOEXCEPT_RELEASE {
-        CPPTOOLS_DEBUG_ASSERT(both_null(where, _root) || in_range_keys(_nodes, where), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "where", where);
+        CPPTOOLS_DEBUG_ASSERT(both_null(where, _root) || _owns(where), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "where", where);
 
-        return where == _rightmost
-            || _rightmost->has_parent(where);
+        return _holds(where, _rightmost);
     }
 
     /// @brief Detach a subtree
     /// @param subtree_root Root of the subtree to be detached
     /// @return A new tree whose root is the detached subtree
+    /// @note Nodes are not moved: both trees then share the node storage of
+    /// this tree, which makes the pool lock its bookkeeping so that both can
+    /// still be mutated from different threads. The storage is only released
+    /// once both trees are gone, both trees iterate over all of it, and side
+    /// data (ancestor labels, subtree sizes and hashes) is sized for all of
+    /// it. Copy the detached subtree instead to give it storage of its own.
     unsafe_tree chop_subtree(node_t* subtree_root) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, subtree_root), "unsafe_tree", critical, "subtree root not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+        CPPTOOLS_DEBUG_ASSERT(_owns(subtree_root),              "unsafe_tree", critical, "subtree root not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+        CPPTOOLS_DEBUG_ASSERT(_batch_depth == 0,                 "unsafe_tree", critical, "cannot chop a subtree within a batch", exception::internal::precondition_failure_error);
 
         if (subtree_root == _root) {
             return unsafe_tree(std::move(*this));
         }
 
-        const bool dropping_leftmost  = (subtree_root == _leftmost)  || (_leftmost->has_parent(subtree_root));
-        const bool dropping_rightmost = (subtree_root == _rightmost) || (_rightmost->has_parent(subtree_root));
+        const bool dropping_leftmost  = _holds(subtree_root, _leftmost);
+        const bool dropping_rightmost = _holds(subtree_root, _rightmost);
 
         node_t* chopped_leftmost = dropping_leftmost
             ? _leftmost
@@ -588,17 +1242,27 @@ public:
             ? _rightmost
             : subtree_root->rightmost_child_or_this();
 
-        storage_t intermediate_storage;
+        // the chopped subtree keeps living in the same pool, under a new owner
+        _owner_id chopped_owner = _pool->make_owner();
+        size_type chopped_size  = _retag_subtree(subtree_root, chopped_owner);
+        _size -= chopped_size;
+        ++_revision;
 
         node_t* parent = subtree_root->parent(); // not null since root case was taken care of already
-        _move_node_ptrs_recursive(subtree_root, intermediate_storage);
-
         parent->remove_child(subtree_root->sibling_index());
+        _resize_path(parent, -static_cast<difference_type>(chopped_size));
+        _invalidate_hashes(parent);
 
-        if (dropping_leftmost)  { _leftmost  = parent; }
-        if (dropping_rightmost) { _rightmost = parent; }
+        if (dropping_leftmost)  { _leftmost  = parent->leftmost_child_or_this(); }
+        if (dropping_rightmost) { _rightmost = parent->rightmost_child_or_this(); }
+
+        unsafe_tree chopped(_pool, chopped_owner, chopped_size, subtree_root, chopped_leftmost, chopped_rightmost, _alloc);
+        if (_sized) {
+            chopped._sized = true;
+            chopped._size_subtree(subtree_root);
+        }
 
-        return unsafe_tree(std::move(intermediate_storage), subtree_root, chopped_leftmost, chopped_rightmost);
+        return chopped;
     }
 
     /// @brief Acquire the nodes of another tree, making it a subtree of this
@@ -607,22 +1271,72 @@ public:
     /// @param other Tree to steal nodes from
     /// @return Pointer to the newly adopted subtree
     node_t* adopt_subtree(node_t* destination, unsafe_tree&& other) {
-        CPPTOOLS_DEBUG_ASSERT(not_empty(other),                   "unsafe_tree", critical, "cannot adopt empty tree", exception::parameter::invalid_value_error, "destination", destination);
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, destination), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "destination", destination);
+        return adopt_subtree(destination, destination->child_count(), std::move(other));
+    }
 
-        bool updating_leftmost  = emplacing_there_would_change_leftmost(destination);
-        bool updating_rightmost = emplacing_there_would_change_rightmost(destination);
+    /// @brief Acquire the nodes of another tree, making it a subtree of this
+    /// tree at some position among the children of a node.
+    /// @param destination Node where that should be parent to the stolen nodes
+    /// @param position Position of the adopted subtree among the children of
+    /// \c destination, which must not be greater than their amount
+    /// @param other Tree to steal nodes from
+    /// @return Pointer to the newly adopted subtree
+    node_t* adopt_subtree(node_t* destination, size_type position, unsafe_tree&& other) {
+        CPPTOOLS_DEBUG_ASSERT(not_empty(other),                       "unsafe_tree", critical, "cannot adopt empty tree", exception::parameter::invalid_value_error, "destination", destination);
+        CPPTOOLS_DEBUG_ASSERT(_owns(destination),                     "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "destination", destination);
+        CPPTOOLS_DEBUG_ASSERT(position <= destination->child_count(), "unsafe_tree", critical, "position out of bounds",  exception::parameter::invalid_value_error, "position", position);
+        CPPTOOLS_DEBUG_ASSERT(_batch_depth == 0,                      "unsafe_tree", critical, "cannot adopt a subtree within a batch", exception::internal::precondition_failure_error);
+
+        // the adopted subtree only becomes an extremum branch when inserted
+        // at the extremity of a node on the extremum path
+        const bool appending = (position == destination->child_count());
+        bool updating_leftmost  = (position == 0) && (destination->leftmost_child_or_this() == _leftmost);
+        bool updating_rightmost = appending && emplacing_there_would_change_rightmost(destination);
 
         node_t* new_subtree = other._root;
-        // steal node ownership
-        other._move_node_ptrs_recursive(new_subtree, _nodes);
-        // attach subtree
-        destination->insert_child(new_subtree);
+        node_t* new_leftmost = other._leftmost;
+        node_t* new_rightmost = other._rightmost;
+
+        if (other._pool == _pool) {
+            // same pool: steal node ownership
+            _retag_subtree(new_subtree, _owner);
+            _size += other._size;
+            if (_sized) {
+                _size_subtree(new_subtree);
+            }
+            other._reset();
+        } else if (other._pool.use_count() == 1 && other._alloc == _alloc) {
+            // pool used by no other tree: steal its blocks
+            _pool->merge(*other._pool, _owner);
+            _size += other._size;
+            if (_sized) {
+                _size_subtree(new_subtree);
+            }
+            other._reset();
+        } else {
+            // nodes cannot be stolen: relocate values
+            _pool->reserve(other._size);
 
-        if (updating_leftmost)  { _leftmost  = other._leftmost;  }
-        if (updating_rightmost) { _rightmost = other._rightmost; }
+            new_subtree   = _replicate_subtree<true>(other._root);
+            new_leftmost  = new_subtree->leftmost_child_or_this();
+            new_rightmost = new_subtree->rightmost_child_or_this();
+            other.clear();
+        }
 
-        other.clear();
+        // attach subtree
+        if (appending) {
+            destination->insert_child(new_subtree);
+        } else {
+            destination->insert_child(new_subtree, position);
+        }
+        _resize_path(destination, _subtree_size(new_subtree));
+        _invalidate_subtree_hashes(new_subtree);
+        _invalidate_hashes(destination);
+        ++_revision;
+        _labels_valid = false;
+
+        if (updating_leftmost)  { _leftmost  = new_leftmost;  }
+        if (updating_rightmost) { _rightmost = new_rightmost; }
 
         return new_subtree;
     }
@@ -668,20 +1382,33 @@ public:
     /// @param destination The node which the moved subtree should be 
     /// @param root The root node of the subtree to move
     void move_subtree(node_t* destination, node_t* subtree_root) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, subtree_root),    "unsafe_tree", critical, "subtree root not in tree",             exception::parameter::invalid_value_error, "subtree_root", subtree_root);
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, destination),     "unsafe_tree", critical, "destination not in tree",              exception::parameter::invalid_value_error, "destination", destination);
+        CPPTOOLS_DEBUG_ASSERT(_owns(subtree_root),                 "unsafe_tree", critical, "subtree root not in tree",             exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+        CPPTOOLS_DEBUG_ASSERT(_owns(destination),                  "unsafe_tree", critical, "destination not in tree",              exception::parameter::invalid_value_error, "destination", destination);
         CPPTOOLS_DEBUG_ASSERT(subtree_root != _root,                  "unsafe_tree", critical, "cannot move the root of the tree",     exception::parameter::invalid_value_error, "subtree_root", subtree_root);
         CPPTOOLS_DEBUG_ASSERT(!destination->has_parent(subtree_root), "unsafe_tree", critical, "destination is part of moved subtree", exception::parameter::invalid_value_error, "destination", destination);
 
-        bool dropping_leftmost  = (subtree_root == _leftmost)  || (_leftmost->has_parent(subtree_root));
-        bool dropping_rightmost = (subtree_root == _rightmost) || (_rightmost->has_parent(subtree_root));
+        if (_batch_depth != 0) {
+            _move_in_batch(destination, subtree_root);
+            return;
+        }
+
+        bool dropping_leftmost  = _holds(subtree_root, _leftmost);
+        bool dropping_rightmost = _holds(subtree_root, _rightmost);
 
         bool updating_leftmost  = emplacing_there_would_change_leftmost(destination);
         bool updating_rightmost = emplacing_there_would_change_rightmost(destination);
 
+        const auto moved_size = static_cast<difference_type>(_subtree_size(subtree_root));
+
         node_t* parent = subtree_root->parent();
         parent->remove_child(subtree_root->sibling_index());
+        _resize_path(parent, -moved_size);
+        _invalidate_hashes(parent);
         destination->insert_child(subtree_root);
+        _resize_path(destination, moved_size);
+        _invalidate_hashes(destination);
+        ++_revision;
+        _labels_valid = false;
 
         // For each extremum node, there are four cases to consider:
         //
@@ -714,26 +1441,138 @@ public:
     /// @brief Erase an entire subtree and its values
     /// @param to_erase The root node of the subtree to erase
     void erase_subtree(node_t* subtree_root) {
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, subtree_root), "unsafe_tree", critical, "subtree root not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
+        CPPTOOLS_DEBUG_ASSERT(_owns(subtree_root),              "unsafe_tree", critical, "subtree root not in tree", exception::parameter::invalid_value_error, "subtree_root", subtree_root);
 
         if (subtree_root == _root) {
             clear();
             return;
         }
 
-        bool dropping_leftmost  = (subtree_root == _leftmost)  || (_leftmost->has_parent(subtree_root));
-        bool dropping_rightmost = (subtree_root == _rightmost) || (_rightmost->has_parent(subtree_root));
+        if (_batch_depth != 0) {
+            _erase_in_batch(subtree_root);
+            return;
+        }
+
+        bool dropping_leftmost  = _holds(subtree_root, _leftmost);
+        bool dropping_rightmost = _holds(subtree_root, _rightmost);
 
         // the actual node can be deleted afterwards
         node_t* parent = subtree_root->parent();
         if (parent) {
             parent->remove_child(subtree_root->sibling_index());
+            _resize_path(parent, -static_cast<difference_type>(_subtree_size(subtree_root)));
+            _invalidate_hashes(parent);
         } 
 
         _delete_subtree_nodes(subtree_root);
 
-        if (dropping_leftmost)  _leftmost  = parent;
-        if (dropping_rightmost) _rightmost = parent;
+        if (dropping_leftmost)  _leftmost  = parent->leftmost_child_or_this();
+        if (dropping_rightmost) _rightmost = parent->rightmost_child_or_this();
+    }
+
+    /// @brief Erase the subtrees rooted at the children of a node which
+    /// satisfy a predicate
+    /// @param parent Node whose children to erase
+    /// @param pred Predicate invoked with a pointer to each child, in order
+    /// @return The amount of children which were erased
+    /// @exception Any exception thrown by the predicate will be forwarded to
+    /// the caller, the children for which it returned true being erased
+    /// @note Runs in time linear in the amount of children plus the amount of
+    /// erased nodes: the children are compacted and their sibling indices
+    /// rewritten once for all erasures.
+    template<typename Pred>
+    size_type remove_children(node_t* parent, Pred pred) {
+        CPPTOOLS_DEBUG_ASSERT(_owns(parent), "unsafe_tree", critical, "parent not in tree", exception::parameter::invalid_value_error, "parent", parent);
+
+        if (_batch_depth != 0) {
+            size_type removed = 0;
+            for (size_type i = 0; i < parent->child_count(); ++i) {
+                node_t* child = parent->child(i);
+                if (child != nullptr && pred(static_cast<const node_t*>(child))) {
+                    _erase_in_batch(child);
+                    ++removed;
+                }
+            }
+
+            return removed;
+        }
+
+        const bool holds_leftmost  = _holds(parent, _leftmost);
+        const bool holds_rightmost = _holds(parent, _rightmost);
+
+        size_type removed       = 0;
+        size_type removed_nodes = 0;
+
+        // erased children leave a null entry behind until all of them are
+        // known, so that their right siblings are only shifted once
+        auto repair = [&]() noexcept {
+            if (removed == 0) {
+                return;
+            }
+
+            parent->compact_children();
+            _resize_path(parent, -static_cast<difference_type>(removed_nodes));
+            _invalidate_hashes(parent);
+
+            if (holds_leftmost)  { _leftmost  = parent->leftmost_child_or_this(); }
+            if (holds_rightmost) { _rightmost = parent->rightmost_child_or_this(); }
+        };
+
+        try {
+            const size_type count = parent->child_count();
+            for (size_type i = 0; i < count; ++i) {
+                node_t* child = parent->child(i);
+                if (!pred(static_cast<const node_t*>(child))) {
+                    continue;
+                }
+
+                parent->vacate_child(i);
+                removed_nodes += _subtree_size(child);
+                ++removed;
+                _delete_subtree_nodes(child);
+            }
+        } catch (...) {
+            repair();
+            throw;
+        }
+
+        repair();
+
+        return removed;
+    }
+
+    /// @brief Erase the subtrees rooted at a range of children of a node
+    /// @param parent Node whose children to erase
+    /// @param first Index of the first child to erase
+    /// @param last Index past the last child to erase
+    /// @note Runs in time linear in the amount of children plus the amount of
+    /// erased nodes: the right siblings of the range are shifted and their
+    /// sibling indices rewritten once for all erasures.
+    void erase_children(node_t* parent, size_type first, size_type last) CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptErasure) {
+        CPPTOOLS_DEBUG_ASSERT(_owns(parent),                                "unsafe_tree", critical, "parent not in tree",   exception::parameter::invalid_value_error, "parent", parent);
+        CPPTOOLS_DEBUG_ASSERT(first <= last && last <= parent->child_count(), "unsafe_tree", critical, "range out of bounds", exception::parameter::invalid_value_error, "last", last);
+        CPPTOOLS_DEBUG_ASSERT(_batch_depth == 0,                            "unsafe_tree", critical, "cannot erase a range of children within a batch", exception::internal::precondition_failure_error);
+
+        if (first == last) {
+            return;
+        }
+
+        const bool holds_leftmost  = _holds(parent, _leftmost);
+        const bool holds_rightmost = _holds(parent, _rightmost);
+
+        size_type removed_nodes = 0;
+        for (size_type i = first; i < last; ++i) {
+            node_t* child = parent->child(i);
+            removed_nodes += _subtree_size(child);
+            _delete_subtree_nodes(child);
+        }
+
+        parent->remove_children(first, last);
+        _resize_path(parent, -static_cast<difference_type>(removed_nodes));
+        _invalidate_hashes(parent);
+
+        if (holds_leftmost)  { _leftmost  = parent->leftmost_child_or_this(); }
+        if (holds_rightmost) { _rightmost = parent->rightmost_child_or_this(); }
     }
 
     /// @brief Emplace a new value in the tree, as a new child node to the
@@ -749,7 +1588,7 @@ public:
     /// will be forwarded to the caller
     template<typename ...ArgTypes>
     node_t* emplace_node(node_t* where, ArgTypes&&... args) CPPTOOLS_NOEXCEPT_RELEASE_AND((std::is_nothrow_constructible_v<value_type, ArgTypes...>)) {
-        CPPTOOLS_DEBUG_ASSERT(null(where) || in_range_keys(_nodes, where), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "where", where);
+        CPPTOOLS_DEBUG_ASSERT(null(where) || _owns(where), "unsafe_tree", critical, "destination not in tree", exception::parameter::invalid_value_error, "where", where);
 
         node_t* child = make_node(std::forward<ArgTypes>(args)...);
 
@@ -759,15 +1598,22 @@ public:
             _root = child;
             if (old_root != nullptr) {
                 child->insert_child(old_root);
+                _resize_path(child, _subtree_size(old_root));
             } else {
                 _leftmost = child;
                 _rightmost = child;
             }
+        } else if (_batch_depth != 0) {
+            // extremum nodes and subtree sizes are fixed when committing
+            where->insert_child(child);
+            _invalidate_hashes(where);
         } else {
             bool update_leftmost  = emplacing_there_would_change_leftmost(where);
             bool update_rightmost = emplacing_there_would_change_rightmost(where);
 
             where->insert_child(child);
+            _resize_path(where, 1);
+            _invalidate_hashes(where);
 
             if (update_leftmost)  _leftmost  = child;
             if (update_rightmost) _rightmost = child;
@@ -789,13 +1635,16 @@ public:
     template<merge_strategy<T> merge_t = merge::keep>
     void merge_with_parent(node_t* n) {
         CPPTOOLS_DEBUG_ASSERT(not_null(n),              "unsafe_tree", critical, "cannot merge null node with parent", exception::parameter::null_parameter_error, "n");
-        CPPTOOLS_DEBUG_ASSERT(in_range_keys(_nodes, n), "unsafe_tree", critical, "node not in tree",                   exception::parameter::invalid_value_error,  "n", n);
+        CPPTOOLS_DEBUG_ASSERT(_owns(n),              "unsafe_tree", critical, "node not in tree",                   exception::parameter::invalid_value_error,  "n", n);
 
         node_t* parent = n->parent();
 
         CPPTOOLS_DEBUG_ASSERT(not_null(parent),         "unsafe_tree", critical, "cannot merge node with null parent", exception::parameter::invalid_value_error,  "n", n);
+        CPPTOOLS_DEBUG_ASSERT(_batch_depth == 0,        "unsafe_tree", critical, "cannot merge a node within a batch",  exception::internal::precondition_failure_error);
 
         parent->template merge_child<merge_t>(n->sibling_index());
+        _resize_path(parent, -1);
+        _invalidate_hashes(parent);
 
         if (_leftmost == n) {
             _leftmost = parent->leftmost_child_or_this();
@@ -807,6 +1656,66 @@ public:
         _delete_node(n);
     }
 
+    /// @brief Open a batch of mutations. Until the batch is committed,
+    /// \c emplace_node, \c erase_subtree and \c move_subtree skip the upkeep
+    /// of extremum nodes, subtree sizes and sibling indices, which is done
+    /// once for the whole batch when committing it.
+    /// @note Batches can be nested, only committing the outermost one has an
+    /// effect.
+    /// @note Within a batch, the tree and its nodes must not be inspected nor
+    /// mutated in any other way than through these three functions.
+    void begin_batch() noexcept {
+        ++_batch_depth;
+    }
+
+    /// @brief Commit a batch of mutations opened with \c begin_batch
+    /// @note Committing the outermost batch runs in linear time if any node
+    /// was erased or moved within it, in time proportional to the height of
+    /// the tree otherwise (plus linear time if subtree sizes are maintained).
+    /// If the ancestor index is enabled and the batch inserted or moved nodes,
+    /// its labels are rebuilt as well, in linear time: mutations made in a
+    /// batch thus leave the tree indexed.
+    /// @note Compacting children never allocates, but computing subtree sizes
+    /// and rebuilding labels may grow their storage to the pool capacity.
+    /// @exception std::bad_alloc Side data could not be grown. The batch is
+    /// closed and the structure of the tree fixed up regardless: subtree
+    /// sizes are disabled, and the ancestor index is left stale.
+    void commit_batch() {
+        CPPTOOLS_DEBUG_ASSERT(_batch_depth != 0, "unsafe_tree", critical, "no batch to commit", exception::internal::precondition_failure_error);
+
+        if (--_batch_depth != 0) {
+            return;
+        }
+
+        // the structure is fixed up first, without allocating
+        if (_root != nullptr) {
+            if (_vacated != 0) {
+                _compact_subtree(_root);
+            }
+
+            _leftmost  = _root->leftmost_child_or_this();
+            _rightmost = _root->rightmost_child_or_this();
+        }
+
+        _vacated = 0;
+
+        if (_sized && _root != nullptr) {
+            try {
+                _size_subtree(_root);
+            } catch (...) {
+                disable_subtree_sizes();
+                throw;
+            }
+        }
+
+        reindex();
+    }
+
+    /// @brief Tell whether a batch of mutations is open on this tree
+    bool in_batch() const noexcept {
+        return _batch_depth != 0;
+    }
+
     /// @brief Check that this tree's structure and values are the same as that
     /// of another tree
     /// @param other Other tree to compare this tree to
@@ -832,72 +1741,382 @@ public:
     /// @brief Swap around the contents of two trees
     /// @param lhs First tree
     /// @param rhs Second tree
-    friend void swap(unsafe_tree& lhs, unsafe_tree& rhs) noexcept(NoExceptSwap) {
-        std::swap(lhs._nodes, rhs._nodes);
+    /// @pre Neither tree may have a batch open, since batches commit to the
+    /// tree object they were opened on rather than to its contents.
+    friend void swap(unsafe_tree& lhs, unsafe_tree& rhs) CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptSwap) {
+        CPPTOOLS_DEBUG_ASSERT(lhs._batch_depth == 0 && rhs._batch_depth == 0, "unsafe_tree", critical, "cannot swap trees within a batch", exception::internal::precondition_failure_error);
+
+        if constexpr (_pocs) {
+            std::swap(lhs._alloc, rhs._alloc);
+        }
+
+        std::swap(lhs._pool, rhs._pool);
+        std::swap(lhs._owner, rhs._owner);
+        std::swap(lhs._size, rhs._size);
         std::swap(lhs._root, rhs._root);
         std::swap(lhs._leftmost, rhs._leftmost);
         std::swap(lhs._rightmost, rhs._rightmost);
+        std::swap(lhs._labels, rhs._labels);
+        std::swap(lhs._indexed, rhs._indexed);
+        std::swap(lhs._labels_valid, rhs._labels_valid);
+        std::swap(lhs._sizes, rhs._sizes);
+        std::swap(lhs._sized, rhs._sized);
+        std::swap(lhs._hashes, rhs._hashes);
+        std::swap(lhs._hashed, rhs._hashed);
+        std::swap(lhs._vacated, rhs._vacated);
+        ++lhs._revision;
+        ++rhs._revision;
     }
 
     /// @brief Get the size of the tree
     size_type size() const {
-        return _nodes.size();
+        return _size;
     }
 
     /// @brief Get the maximum size the tree can have
     size_type max_size() const {
-        return _nodes.max_size();
+        return _al_traits::max_size(_alloc);
     }
 
     /// @brief Get whether the tree is empty
     bool empty() const {
-        return _nodes.empty();
+        return _size == 0;
     }
 
     /// @brief Clear the tree
-    void clear() {
-        _nodes.clear();
-        _root = nullptr;
-        _leftmost = nullptr;
-        _rightmost = nullptr;
+    /// @note If the node storage of this tree is not shared with any other
+    /// tree, it is released in bulk. Otherwise, nodes are destroyed one by one
+    /// and this tree stops sharing its storage.
+    void clear() CPPTOOLS_NOEXCEPT_RELEASE_AND(NoExceptErasure) {
+        if (_pool.use_count() == 1) {
+            _pool->clear();
+        } else if (_pool) {
+            if (_root != nullptr) {
+                _delete_subtree_nodes(_root);
+            }
+            _release_pool();
+        }
+
+        _size         = 0;
+        _root         = nullptr;
+        _leftmost     = nullptr;
+        _rightmost    = nullptr;
+        _labels_valid = false;
+        ++_revision;
+    }
+
+    /// @brief Maintain interval labels so that ancestor queries run in
+    /// constant time. Labels are built right away, and insertions or moves
+    /// make them stale until \c reindex is called or the batch they were made
+    /// in is committed: in the meantime, queries walk up the tree.
+    /// @note Rebuilding labels takes linear time: group insertions and moves
+    /// in batches so that it is paid once per batch.
+    void enable_ancestor_index() {
+        _indexed = true;
+        _rebuild_labels();
+    }
+
+    /// @brief Bring the ancestor index up to date after insertions or moves,
+    /// in linear time, if it is enabled and stale
+    /// @note Queries never rebuild the labels themselves, so that concurrent
+    /// queries on a tree which is not being mutated do not race.
+    void reindex() {
+        if (_indexed && !_labels_valid) {
+            _rebuild_labels();
+        }
+    }
+
+    /// @brief Stop maintaining interval labels and release their storage
+    void disable_ancestor_index() {
+        _indexed      = false;
+        _labels_valid = false;
+        _labels.clear();
+        _labels.shrink_to_fit();
+    }
+
+    /// @brief Keep track of the amount of nodes in the subtree of every node,
+    /// updating them along the parent path of every mutation. Descendant
+    /// counts then run in constant time, and nodes can be looked up by their
+    /// position in a pre-order traversal.
+    /// @note Sizes are kept apart from the nodes, indexed by pool slot, so
+    /// that trees which do not keep track of them do not pay for them. Sizes
+    /// of the existing nodes are computed in linear time.
+    void enable_subtree_sizes() {
+        if (!_sized && _root != nullptr) {
+            _size_subtree(_root);
+        }
+
+        _sized = true;
+    }
+
+    /// @brief Stop keeping track of subtree sizes and release their storage
+    void disable_subtree_sizes() noexcept {
+        _sized = false;
+        _sizes.clear();
+        _sizes.shrink_to_fit();
+    }
+
+    /// @brief Tell whether the tree keeps track of the amount of nodes in the
+    /// subtree of every node
+    bool has_subtree_sizes() const noexcept {
+        return _sized;
+    }
+
+    /// @brief Get the amount of nodes below a node
+    /// @param n Node whose descendants to count
+    /// @note Runs in constant time if subtree sizes are kept track of,
+    /// otherwise counts the nodes of the subtree.
+    size_type descendant_count(const node_t* n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_owns(n), "unsafe_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        return _sized
+            ? _sizes[_pool_t::slot_of(n)] - 1
+            : n->descendant_count();
+    }
+
+    /// @brief Get the node at some position in a pre-order traversal of the
+    /// tree
+    /// @param index Position of the node to find
+    /// @pre Subtree sizes must be kept track of.
+    /// @pre \c index must be lower than the size of the tree.
+    /// @note Runs in time proportional to the depth of the node times the
+    /// amount of children of its ancestors.
+    node_t* nth_pre_order(size_type index) CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_sized,        "unsafe_tree", critical, "subtree sizes are not kept track of", exception::internal::precondition_failure_error);
+        CPPTOOLS_DEBUG_ASSERT(index < _size, "unsafe_tree", critical, "index out of bounds",                 exception::parameter::invalid_value_error, "index", index);
+
+        return _nth_in_subtree(_root, index);
+    }
+
+    /// @copydoc unsafe_tree<T>::nth_pre_order
+    const node_t* nth_pre_order(size_type index) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_sized,        "unsafe_tree", critical, "subtree sizes are not kept track of", exception::internal::precondition_failure_error);
+        CPPTOOLS_DEBUG_ASSERT(index < _size, "unsafe_tree", critical, "index out of bounds",                 exception::parameter::invalid_value_error, "index", index);
+
+        return _nth_in_subtree(static_cast<const node_t*>(_root), index);
+    }
+
+    /// @brief Get the position of a node in a pre-order traversal of the tree
+    /// @param n Node whose position to get
+    /// @pre Subtree sizes must be kept track of.
+    /// @note Runs in time proportional to the depth of the node times the
+    /// amount of children of its ancestors.
+    size_type pre_order_index(const node_t* n) const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_sized,   "unsafe_tree", critical, "subtree sizes are not kept track of", exception::internal::precondition_failure_error);
+        CPPTOOLS_DEBUG_ASSERT(_owns(n), "unsafe_tree", critical, "node not in tree",                    exception::parameter::invalid_value_error, "n", n);
+
+        size_type index = 0;
+        for (; n->parent() != nullptr; n = n->parent()) {
+            const node_t* parent = n->parent();
+            const size_type sibling_index = n->sibling_index();
+
+            // the parent and all left siblings come before the node
+            ++index;
+            for (size_type i = 0; i < sibling_index; ++i) {
+                index += _sizes[_pool_t::slot_of(parent->child(i))];
+            }
+        }
+
+        return index;
+    }
+
+    /// @brief Have every node cache a hash of its subtree, combining its value
+    /// with the hashes of its children. Hashes are invalidated along the parent
+    /// path of every mutation and recomputed by \c rehash, so that locating
+    /// the differences between two trees only visits the subtrees which differ.
+    /// @note Values modified in place through a node must be reported with
+    /// \c touch, since the tree cannot see such modifications.
+    /// @note Hashes of the existing nodes are computed in linear time.
+    void enable_hashing() requires hashable<T> {
+        if (!_hashed) {
+            _hashes.assign(slot_count(), _subtree_hash{ 0, false });
+        }
+
+        _hashed = true;
+        rehash();
+    }
+
+    /// @brief Stop maintaining subtree hashes and release their storage
+    void disable_hashing() {
+        _hashed = false;
+        _hashes.clear();
+        _hashes.shrink_to_fit();
+    }
+
+    /// @brief Tell whether subtree hashes are maintained
+    bool has_hashing() const noexcept {
+        return _hashed;
+    }
+
+    /// @brief Report that the value of a node was modified in place
+    /// @param n Node whose value was modified
+    void touch(const node_t* n) CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_owns(n), "unsafe_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+
+        _invalidate_hashes(n);
+    }
+
+    /// @brief Recompute the subtree hashes which went stale since the last
+    /// call, so that later queries do not have to
+    /// @pre Subtree hashes must be maintained.
+    void rehash() requires hashable<T> {
+        CPPTOOLS_DEBUG_ASSERT(_hashed, "unsafe_tree", critical, "subtree hashes are not maintained", exception::internal::precondition_failure_error);
+
+        if (_root != nullptr) {
+            _hash_of(_root, &_hashes);
+        }
+    }
+
+    /// @brief Tell whether every cached subtree hash is up to date, that is
+    /// whether \c rehash was called since the last mutation
+    /// @pre Subtree hashes must be maintained.
+    bool hashes_up_to_date() const CPPTOOLS_NOEXCEPT_RELEASE {
+        CPPTOOLS_DEBUG_ASSERT(_hashed, "unsafe_tree", critical, "subtree hashes are not maintained", exception::internal::precondition_failure_error);
+
+        // ancestors of a stale node are stale too
+        return _root == nullptr || _hashes[_pool_t::slot_of(_root)].valid;
+    }
+
+    /// @brief Get the hash of a subtree
+    /// @param n Root of the subtree to hash
+    /// @pre Subtree hashes must be maintained.
+    /// @note Nodes whose hash went stale since the last call to \c rehash are
+    /// hashed again on every query, without updating the cache, so that
+    /// queries may run concurrently.
+    std::size_t subtree_hash(const node_t* n) const requires hashable<T> {
+        CPPTOOLS_DEBUG_ASSERT(_hashed,  "unsafe_tree", critical, "subtree hashes are not maintained", exception::internal::precondition_failure_error);
+        CPPTOOLS_DEBUG_ASSERT(_owns(n), "unsafe_tree", critical, "node not in tree",                  exception::parameter::invalid_value_error, "n", n);
+
+        return _hash_of(n, nullptr);
+    }
+
+    /// @brief Find where this tree and another one differ, only descending
+    /// into subtrees whose hashes differ
+    /// @param other Tree to compare this tree to
+    /// @return Topmost pairs of nodes, at the same position in both trees,
+    /// whose values or amounts of children differ, in pre-order. If only one
+    /// tree is empty, the pair of roots is returned, one of them being null.
+    /// @pre Subtree hashes must be maintained in both trees.
+    /// @note Subtrees with equal hashes are assumed to be equal: a hash
+    /// collision, or a value modified in place without calling \c touch, can
+    /// hide a difference. Compare trees with \c operator== for an exact answer.
+    std::vector<std::pair<const node_t*, const node_t*>> differing_subtrees(const unsafe_tree& other) const requires hashable<T> {
+        CPPTOOLS_DEBUG_ASSERT(_hashed && other._hashed, "unsafe_tree", critical, "subtree hashes are not maintained", exception::internal::precondition_failure_error);
+
+        using node_pair = std::pair<const node_t*, const node_t*>;
+        std::vector<node_pair> result;
+
+        if (_root == nullptr || other._root == nullptr) {
+            if (_root != other._root) {
+                result.emplace_back(_root, other._root);
+            }
+
+            return result;
+        }
+
+        std::vector<node_pair> pending = { { _root, other._root } };
+        while (!pending.empty()) {
+            auto [lhs, rhs] = pending.back();
+            pending.pop_back();
+
+            if (_hash_of(lhs, nullptr) == other._hash_of(rhs, nullptr)) {
+                continue;
+            }
+
+            if (lhs->child_count() != rhs->child_count() || lhs->value() != rhs->value()) {
+                result.emplace_back(lhs, rhs);
+                continue;
+            }
+
+            // stacked in reverse so that differences come out in pre-order
+            for (size_type i = lhs->child_count(); i-- != 0; ) {
+                pending.emplace_back(lhs->child(i), rhs->child(i));
+            }
+        }
+
+        return result;
+    }
+
+    /// @brief Get a counter which changes whenever nodes are added to, removed
+    /// from or moved within the tree, for structures derived from the tree to
+    /// detect that they went stale
+    size_type revision() const {
+        return _revision;
+    }
+
+    /// @brief Get the index of the pool slot holding a node. Slot indices are
+    /// lower than \c slot_count(), and do not change for as long as the node
+    /// stays in the same tree.
+    static size_type slot_of(const node_t* n) noexcept {
+        return _pool_t::slot_of(n);
+    }
+
+    /// @brief Get the amount of pool slots which nodes of this tree may occupy
+    size_type slot_count() const {
+        return _pool ? _pool->capacity() : 0;
+    }
+
+    /// @brief Tell whether ancestor queries are answered from interval labels
+    bool has_ancestor_index() const {
+        return _indexed;
+    }
+
+    /// @brief Tell whether the ancestor index is enabled and reflects the
+    /// current structure of the tree, so that ancestor queries run in
+    /// constant time
+    bool ancestor_index_up_to_date() const noexcept {
+        return _indexed && _labels_valid;
+    }
+
+    /// @brief Tell whether a node is a strict descendant of another
+    /// @param n Node whose ancestry to check
+    /// @param ancestor Node which should be an ancestor to \c n
+    /// @return Whether \c ancestor is a strict ancestor of \c n
+    /// @note Runs in constant time if the ancestor index is enabled and up to
+    /// date, see \c reindex. Otherwise, walks up from \c n.
+    bool has_parent(const node_t* n, const node_t* ancestor) const {
+        CPPTOOLS_DEBUG_ASSERT(_owns(n),        "unsafe_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "n", n);
+        CPPTOOLS_DEBUG_ASSERT(_owns(ancestor), "unsafe_tree", critical, "node not in tree", exception::parameter::invalid_value_error, "ancestor", ancestor);
+
+        return _has_parent(n, ancestor);
     }
 
     /// @brief Get the begin iterator for a fast traversal of the tree (no order
     /// guarantee)
     /// @return The begin iterator for a fast traversal of the tree
     iterator begin() {
-        return values().begin();
+        return _pool ? _pool->begin(_owner) : iterator();
     }
 
     /// @brief Get the end iterator for a fast traversal of the tree (no order
     /// guarantee)
     /// @return The end iterator for a fast traversal of the tree
     iterator end() {
-        return values().end();
+        return _pool ? _pool->end(_owner) : iterator();
     }
 
     /// @brief Get the begin iterator for a fast const traversal of the tree (no
     /// order guarantee)
     /// @return The begin iterator for a fast const traversal of the tree
     const_iterator cbegin() const {
-        return const_values().begin();
+        return _pool ? std::as_const(*_pool).begin(_owner) : const_iterator();
     }
 
     /// @brief Get the end iterator for a fast const traversal of the tree (no
     /// order guarantee)
     /// @return The end iterator for a fast const traversal of the tree
     const_iterator cend() const {
-        return const_values().end();
+        return _pool ? std::as_const(*_pool).end(_owner) : const_iterator();
     }
 
     /// @copydoc unsafe_tree<T>::cbegin
     const_iterator begin() const {
-        return const_values().begin();
+        return cbegin();
     }
 
     /// @copydoc unsafe_tree<T>::cend
     const_iterator end() const {
-        return const_values().end();
+        return cend();
     }
 };
 
@@ -915,8 +2134,6 @@ public:
  - profile different impls for _subtrees_equal:
     - compare structure when stacking, and then values only when unstacking
     - recursive version
- - _copy_assign_contents should be iterative (reuse _move_assign_contents)
  - reverberate allocator awareness in tree.hpp
  - swap
- - investigate reusing nodes instead of clearing and then copying during copy-assignment
  */
\ No newline at end of file
@@ -0,0 +1,313 @@
+#ifndef CPPTOOLS_CONTAINER_TREE_DIFF_HPP
+#define CPPTOOLS_CONTAINER_TREE_DIFF_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <cpptools/utility/hash_combine.hpp>
+
+#include "tree.hpp"
+
+namespace tools {
+
+/// @brief Edits making up an edit script, as produced by \c diff. Nodes are
+/// designated by their path from the root of the tree being edited: the index
+/// of a child of the root, then that of one of its children, and so on. Paths
+/// are relative to the state of the tree at the time the edit is applied.
+namespace edit {
+
+/// @brief Replace the value of a node
+template<typename T>
+struct assign {
+    std::vector<std::size_t> path;
+    T value;
+};
+
+/// @brief Erase a subtree. An empty path clears the tree.
+struct erase {
+    std::vector<std::size_t> path;
+};
+
+/// @brief Insert a subtree among the children of a node. Inserting into an
+/// empty tree makes the subtree the whole tree, regardless of path and
+/// position.
+template<typename T>
+struct insert {
+    std::vector<std::size_t> path;
+    std::size_t position;
+    tree<T> subtree;
+};
+
+} // namespace edit
+
+template<typename T>
+using tree_edit = std::variant<edit::assign<T>, edit::erase, edit::insert<T>>;
+
+/// @brief Sequence of edits turning a tree into another one
+template<typename T>
+using tree_edit_script = std::vector<tree_edit<T>>;
+
+namespace detail {
+
+/// @brief Computes edit scripts between two trees by comparing subtree
+/// hashes, only descending into subtrees which differ
+template<typename T>
+class tree_differ {
+    using tree_t = unsafe_tree<T>;
+    using node_t = typename tree_t::node_t;
+
+    /// @brief Pair of nodes at the same position in both trees, along with
+    /// their path
+    struct _work_item {
+        const node_t* from;
+        const node_t* to;
+        std::vector<std::size_t> path;
+    };
+
+    const tree_t& _from;
+    const tree_t& _to;
+
+    /// @brief Subtree hashes of the nodes of both trees, indexed by pool slot,
+    /// unless both trees maintain their own and they are up to date
+    std::vector<std::size_t> _from_hashes;
+    std::vector<std::size_t> _to_hashes;
+
+    /// @brief Whether hashes maintained by the trees can be used
+    bool _cached;
+
+    static bool _has_fresh_hashes(const tree_t& t) {
+        return t.has_hashing() && t.hashes_up_to_date();
+    }
+
+    static const node_t* _leftmost_below(const node_t* n) noexcept {
+        while (n->child_count() != 0) {
+            n = n->child(0);
+        }
+
+        return n;
+    }
+
+    /// @brief Hash all subtrees of a tree in one post-order pass
+    static std::vector<std::size_t> _hash_all(const tree_t& t) {
+        std::vector<std::size_t> hashes(t.slot_count());
+        const node_t* root = t.root();
+        if (root == nullptr) {
+            return hashes;
+        }
+
+        const node_t* n = _leftmost_below(root);
+        while (true) {
+            std::size_t hash = std::hash<T>{}(n->value());
+            hash_combine(hash, n->child_count());
+            for (const node_t* child : n->children()) {
+                hash_combine(hash, hashes[tree_t::slot_of(child)]);
+            }
+            hashes[tree_t::slot_of(n)] = hash;
+
+            if (n == root) {
+                break;
+            }
+
+            n = n->is_rightmost_sibling()
+                ? n->parent()
+                : _leftmost_below(n->right_sibling());
+        }
+
+        return hashes;
+    }
+
+    /// @brief Tell whether two subtrees have the same shape and values
+    static bool _equal(const node_t* from, const node_t* to) {
+        std::vector<std::pair<const node_t*, const node_t*>> pending = { { from, to } };
+        while (!pending.empty()) {
+            auto [lhs, rhs] = pending.back();
+            pending.pop_back();
+
+            if (lhs->child_count() != rhs->child_count() || lhs->value() != rhs->value()) {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < lhs->child_count(); ++i) {
+                pending.emplace_back(lhs->child(i), rhs->child(i));
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief Tell whether two subtrees are equal. Differing hashes tell
+    /// subtrees apart right away, equal hashes are confirmed by comparing the
+    /// subtrees, so that neither a collision nor a value modified in place
+    /// without being reported yields a wrong script.
+    bool _same(const node_t* from, const node_t* to) const {
+        const bool same_hash = _cached
+            ? _from.subtree_hash(from) == _to.subtree_hash(to)
+            : _from_hashes[tree_t::slot_of(from)] == _to_hashes[tree_t::slot_of(to)];
+
+        return same_hash && _equal(from, to);
+    }
+
+    static std::vector<std::size_t> _child_path(const std::vector<std::size_t>& path, std::size_t index) {
+        std::vector<std::size_t> result;
+        result.reserve(path.size() + 1);
+        result.assign(path.begin(), path.end());
+        result.push_back(index);
+
+        return result;
+    }
+
+public:
+    tree_differ(const tree<T>& from, const tree<T>& to) :
+        _from(static_cast<const tree_t&>(from)),
+        _to(static_cast<const tree_t&>(to)),
+        _from_hashes(),
+        _to_hashes(),
+        _cached(_has_fresh_hashes(_from) && _has_fresh_hashes(_to))
+    {
+        if (!_cached) {
+            _from_hashes = _hash_all(_from);
+            _to_hashes   = _hash_all(_to);
+        }
+    }
+
+    tree_edit_script<T> script() const {
+        tree_edit_script<T> result;
+
+        const node_t* from_root = _from.root();
+        const node_t* to_root   = _to.root();
+
+        if (from_root == nullptr || to_root == nullptr) {
+            if (from_root != nullptr) {
+                result.emplace_back(edit::erase{ {} });
+            } else if (to_root != nullptr) {
+                result.emplace_back(edit::insert<T>{ {}, 0, tree<T>(const_node_handle<T>(to_root)) });
+            }
+
+            return result;
+        }
+
+        std::vector<_work_item> pending;
+        if (!_same(from_root, to_root)) {
+            pending.push_back({ from_root, to_root, {} });
+        }
+
+        while (!pending.empty()) {
+            _work_item item = std::move(pending.back());
+            pending.pop_back();
+
+            if (item.from->value() != item.to->value()) {
+                result.emplace_back(edit::assign<T>{ item.path, item.to->value() });
+            }
+
+            // children which are the same at both ends of the lists are left
+            // alone, those in-between are paired by position
+            const std::size_t from_count = item.from->child_count();
+            const std::size_t to_count   = item.to->child_count();
+            const std::size_t min_count  = std::min(from_count, to_count);
+
+            std::size_t prefix = 0;
+            while (prefix < min_count && _same(item.from->child(prefix), item.to->child(prefix))) {
+                ++prefix;
+            }
+
+            std::size_t suffix = 0;
+            while (suffix < min_count - prefix && _same(item.from->child(from_count - 1 - suffix), item.to->child(to_count - 1 - suffix))) {
+                ++suffix;
+            }
+
+            const std::size_t from_middle = from_count - prefix - suffix;
+            const std::size_t to_middle   = to_count   - prefix - suffix;
+            const std::size_t paired      = std::min(from_middle, to_middle);
+
+            // extra children come after the paired ones, editing them does not
+            // shift the paired children
+            for (std::size_t i = paired; i < from_middle; ++i) {
+                result.emplace_back(edit::erase{ _child_path(item.path, prefix + paired) });
+            }
+
+            for (std::size_t i = paired; i < to_middle; ++i) {
+                const node_t* inserted = item.to->child(prefix + i);
+                result.emplace_back(edit::insert<T>{ item.path, prefix + i, tree<T>(const_node_handle<T>(inserted)) });
+            }
+
+            // stacked in reverse so that edits come out in pre-order
+            for (std::size_t i = paired; i-- != 0; ) {
+                const node_t* from_child = item.from->child(prefix + i);
+                const node_t* to_child   = item.to->child(prefix + i);
+
+                if (!_same(from_child, to_child)) {
+                    pending.push_back({ from_child, to_child, _child_path(item.path, prefix + i) });
+                }
+            }
+        }
+
+        return result;
+    }
+};
+
+} // namespace detail
+
+/// @brief Compute an edit script turning a tree into another one
+/// @param from Tree to be edited
+/// @param to Tree which the edited tree should become
+/// @return Edits which, applied in order to \c from through \c patch, make it
+/// equal to \c to
+/// @note Subtrees are compared by hash, using the hashes maintained by both
+/// trees if they both have hashing enabled and were rehashed since their last
+/// mutation, or hashing both trees in full otherwise. Subtrees with differing hashes are told apart right away, those
+/// with equal hashes are compared node by node, so that the script is exact
+/// even if hashes collide. Children are matched by position, after leaving
+/// out those which are equal at both ends of their lists: small localized
+/// edits yield small scripts.
+template<hashable T>
+tree_edit_script<T> diff(const tree<T>& from, const tree<T>& to) {
+    return detail::tree_differ<T>(from, to).script();
+}
+
+/// @brief Apply an edit script to a tree
+/// @param t Tree to edit
+/// @param script Edits to apply, in order
+/// @note Values assigned by the script are reported to the tree, so that
+/// its subtree hashes stay up to date.
+template<typename T>
+void patch(tree<T>& t, const tree_edit_script<T>& script) {
+    auto resolve = [&t](const std::vector<std::size_t>& path) {
+        auto n = t.root();
+        for (std::size_t index : path) {
+            n = n.child(index);
+        }
+
+        return n;
+    };
+
+    for (const auto& e : script) {
+        if (const auto* assign = std::get_if<edit::assign<T>>(&e)) {
+            auto n = resolve(assign->path);
+            *n = assign->value;
+            if (t.has_hashing()) {
+                t.touch(n);
+            }
+        } else if (const auto* erase = std::get_if<edit::erase>(&e)) {
+            if (erase->path.empty()) {
+                t.clear();
+            } else {
+                t.erase_subtree(resolve(erase->path));
+            }
+        } else {
+            const auto& insert = std::get<edit::insert<T>>(e);
+            if (t.empty()) {
+                t = insert.subtree;
+            } else {
+                t.adopt_subtree(resolve(insert.path), insert.position, insert.subtree);
+            }
+        }
+    }
+}
+
+} // namespace tools
+
+#endif//CPPTOOLS_CONTAINER_TREE_DIFF_HPP
@@ -0,0 +1,63 @@
+#ifndef CPPTOOLS_THREAD_EVENT_COUNT_HPP
+#define CPPTOOLS_THREAD_EVENT_COUNT_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace tools::detail {
+
+/// @brief Lets threads park until a condition holds, without making threads
+/// which make the condition hold pay for more than a fence and a load while
+/// nobody is parked
+class event_count {
+    /// @brief Incremented on every notification with threads parked, parked
+    /// threads wait on it to change
+    std::atomic<std::uint32_t> _epoch;
+
+    /// @brief Amount of threads parked or about to park
+    std::atomic<std::uint32_t> _waiters;
+
+public:
+    event_count() noexcept :
+        _epoch(0),
+        _waiters(0)
+    {
+
+    }
+
+    event_count(const event_count&) = delete;
+    event_count& operator=(const event_count&) = delete;
+
+    /// @brief Wake up parked threads so that they check their condition
+    /// @note Call this after making the condition of parked threads hold.
+    void notify() noexcept {
+        // Pairs with the fence in wait_until: either the waiter sees the
+        // condition hold, or this sees the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_relaxed) != 0) {
+            _epoch.fetch_add(1, std::memory_order_release);
+            _epoch.notify_all();
+        }
+    }
+
+    /// @brief Park the calling thread until a condition holds
+    /// @param ready Condition to be checked, possibly several times
+    template<typename Pred>
+    void wait_until(Pred&& ready) {
+        while (!ready()) {
+            _waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const auto epoch = _epoch.load(std::memory_order_acquire);
+            if (!ready()) {
+                _epoch.wait(epoch, std::memory_order_acquire);
+            }
+
+            _waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace tools::detail
+
+#endif//CPPTOOLS_THREAD_EVENT_COUNT_HPP
@@ -0,0 +1,289 @@
+#ifndef CPPTOOLS_THREAD_MPMC_QUEUE_HPP
+#define CPPTOOLS_THREAD_MPMC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/thread/event_count.hpp>
+
+namespace tools {
+
+/// @brief Bounded lock-free queue for any amount of producer and consumer
+/// threads, after Dmitry Vyukov's ring buffer. Every slot carries a sequence
+/// number telling whether it is ready to be written or read at a given
+/// position, so that producers and consumers only contend on their own
+/// position counter.
+/// @tparam T Type of the queued items, which must be nothrow movable
+/// @note Blocking operations spin for a while, then park until the queue
+/// changes.
+template<typename T>
+class mpmc_queue {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "queued items are moved in and out of the ring while it is being published");
+
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+
+    /// @brief Amount of attempts blocking operations make before parking
+    static constexpr size_type default_spin_count = 1 << 8;
+
+private:
+    /// @brief Assumed cache line size, std::hardware_destructive_interference_size
+    /// not being ABI-stable
+    static constexpr size_type _cache_line = 64;
+
+    struct _cell {
+        /// @brief Position at which the cell can be written if equal to it,
+        /// or read if equal to it plus one
+        std::atomic<size_type> sequence;
+
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T* value() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    std::unique_ptr<_cell[]> _cells;
+    size_type _mask;
+    size_type _spin_count;
+
+    /// @brief Position of the next item to be pushed
+    alignas(_cache_line) std::atomic<size_type> _enqueue_pos;
+
+    /// @brief Position of the next item to be popped
+    alignas(_cache_line) std::atomic<size_type> _dequeue_pos;
+
+    /// @brief Consumers waiting for items park here
+    alignas(_cache_line) detail::event_count _not_empty;
+
+    /// @brief Producers waiting for room park here
+    alignas(_cache_line) detail::event_count _not_full;
+
+    /// @brief Claim the cell at the next position to push to
+    /// @return The claimed cell, or nullptr if the queue is full
+    _cell* _claim_push(size_type& pos) noexcept {
+        pos = _enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            _cell* cell = &_cells[pos & _mask];
+            const size_type sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return cell;
+                }
+            } else if (diff < 0) {
+                // The cell still holds the item pushed one lap ago
+                return nullptr;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Claim the cell at the next position to pop from
+    /// @return The claimed cell, or nullptr if the queue is empty
+    _cell* _claim_pop(size_type& pos) noexcept {
+        pos = _dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            _cell* cell = &_cells[pos & _mask];
+            const size_type sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return cell;
+                }
+            } else if (diff < 0) {
+                // The item of this lap has not been pushed yet
+                return nullptr;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Push an item if there is room, moving from it only then
+    bool _try_push(T& value) noexcept {
+        size_type pos;
+        _cell* cell = _claim_push(pos);
+        if (!cell) {
+            return false;
+        }
+
+        std::construct_at(cell->value(), std::move(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        _not_empty.notify();
+
+        return true;
+    }
+
+    /// @brief Spin for a while, then park, until an operation succeeds
+    template<typename Op>
+    void _spin_then_park(detail::event_count& event, Op&& op) {
+        for (size_type i = 0; i < _spin_count; ++i) {
+            if (op()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        event.wait_until(op);
+    }
+
+public:
+    /// @param capacity Minimum amount of items the queue can hold, rounded up
+    /// to a power of two
+    /// @param spin_count Amount of attempts blocking operations make before
+    /// parking
+    /// @exception tools::exception::parameter::invalid_value_error The
+    /// capacity is zero.
+    explicit mpmc_queue(size_type capacity, size_type spin_count = default_spin_count) :
+        _cells(),
+        _mask(0),
+        _spin_count(spin_count),
+        _enqueue_pos(0),
+        _dequeue_pos(0)
+    {
+        if (capacity == 0) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "capacity", capacity);
+        }
+
+        capacity = std::bit_ceil(std::max<size_type>(capacity, 2));
+        _cells = std::make_unique<_cell[]>(capacity);
+        _mask = capacity - 1;
+
+        for (size_type i = 0; i < capacity; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue() {
+        while (try_pop()) {
+
+        }
+    }
+
+    size_type capacity() const noexcept {
+        return _mask + 1;
+    }
+
+    /// @brief Get the amount of items in the queue, which may already have
+    /// changed by the time it is returned
+    size_type size_approx() const noexcept {
+        const size_type dequeue_pos = _dequeue_pos.load(std::memory_order_relaxed);
+        const size_type enqueue_pos = _enqueue_pos.load(std::memory_order_relaxed);
+        const auto diff = static_cast<std::ptrdiff_t>(enqueue_pos - dequeue_pos);
+
+        return static_cast<size_type>(std::clamp<std::ptrdiff_t>(diff, 0, static_cast<std::ptrdiff_t>(capacity())));
+    }
+
+    /// @brief Tell whether the next item to be popped is not there yet, which
+    /// may already have changed by the time it is returned
+    bool empty() const noexcept {
+        const size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+        return _cells[pos & _mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    /// @brief Push an item if there is room
+    /// @return Whether the item was pushed. It is left untouched otherwise.
+    bool try_push(T&& value) noexcept {
+        return _try_push(value);
+    }
+
+    /// @brief Push a copy of an item if there is room
+    /// @return Whether the item was pushed
+    bool try_push(const T& value) {
+        T copy(value);
+        return _try_push(copy);
+    }
+
+    /// @brief Push an item, waiting for room if the queue is full
+    void push(T value) {
+        _spin_then_park(_not_full, [&]{ return _try_push(value); });
+    }
+
+    /// @brief Pop the oldest item if there is one
+    std::optional<T> try_pop() noexcept {
+        size_type pos;
+        _cell* cell = _claim_pop(pos);
+        if (!cell) {
+            return std::nullopt;
+        }
+
+        std::optional<T> result(std::move(*cell->value()));
+        std::destroy_at(cell->value());
+        cell->sequence.store(pos + capacity(), std::memory_order_release);
+        _not_full.notify();
+
+        return result;
+    }
+
+    /// @brief Pop up to some amount of items, oldest first
+    /// @param out Output iterator the popped items are moved to
+    /// @param max_count Maximum amount of items to pop
+    /// @return The amount of items popped
+    /// @note If writing to the output iterator throws, the item being written
+    /// is lost.
+    template<typename OutputIt>
+    size_type try_pop_n(OutputIt out, size_type max_count) {
+        size_type count = 0;
+        for (; count < max_count; ++count) {
+            auto value = try_pop();
+            if (!value) {
+                break;
+            }
+
+            *out = std::move(*value);
+            ++out;
+        }
+
+        return count;
+    }
+
+    /// @brief Pop the oldest item, waiting for one if the queue is empty
+    T pop() {
+        std::optional<T> result;
+        _spin_then_park(_not_empty, [&]{
+            result = try_pop();
+            return result.has_value();
+        });
+
+        return std::move(*result);
+    }
+
+    /// @brief Wait until the queue seems not empty, or until a condition
+    /// holds
+    /// @param interrupted Condition to stop waiting on, which must be made to
+    /// hold before calling wake_consumers
+    template<typename Pred>
+    void wait_for_items(Pred&& interrupted) {
+        _spin_then_park(_not_empty, [&]{
+            return !empty() || interrupted();
+        });
+    }
+
+    /// @brief Wake up threads waiting for items, so that they check their
+    /// interruption condition
+    void wake_consumers() noexcept {
+        _not_empty.notify();
+    }
+};
+
+} // namespace tools
+
+#endif//CPPTOOLS_THREAD_MPMC_QUEUE_HPP
@@ -0,0 +1,218 @@
+#include "periodic_worker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+
+namespace tools {
+
+namespace {
+
+/// @brief Reject periods which would have the worker run its task in a
+/// busy loop, before the worker thread gets a chance to start
+periodic_worker::clock::duration checked_period(periodic_worker::clock::duration period) {
+    if (period <= periodic_worker::clock::duration::zero()) {
+        CPPTOOLS_THROW(exception::parameter::invalid_value_error, "period", period.count());
+    }
+
+    return period;
+}
+
+}
+
+periodic_worker::periodic_worker(
+    clock::duration period,
+    task_fun task,
+    bool start_now,
+    overrun_policy policy,
+    clock::duration spin_threshold
+) :
+    _period(checked_period(period)),
+    _task(std::move(task)),
+    _policy(policy),
+    _spin_threshold(spin_threshold),
+    _next_deadline(),
+    _interrupted(!start_now),
+    _sem_interrupt(0),
+    _stats(),
+    _lateness_mean(0.),
+    _lateness_m2(0.),
+    _worker(
+        [this]{ _tick(); },
+        start_now,
+        []{},
+        []{},
+        // Deadlines start over from the time the worker (re)starts, rather
+        // than trying to catch up with the time spent paused
+        [this]{ _next_deadline = clock::now(); }
+    )
+{
+
+}
+
+periodic_worker::~periodic_worker() {
+    // The worker cannot notice it is asked to finalize while sleeping
+    finalize();
+    _worker.wait_until_finalized(false);
+}
+
+periodic_worker::jitter_stats periodic_worker::stats() {
+    auto l = std::unique_lock<std::mutex>(_mutex_stats);
+
+    jitter_stats stats = _stats;
+    stats.mean_lateness = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double, clock::period>(_lateness_mean)
+    );
+    if (stats.iterations > 1) {
+        stats.lateness_stddev = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double, clock::period>(std::sqrt(_lateness_m2 / static_cast<double>(stats.iterations - 1)))
+        );
+    }
+
+    return stats;
+}
+
+void periodic_worker::reset_stats() {
+    auto l = std::unique_lock<std::mutex>(_mutex_stats);
+    _stats = jitter_stats();
+    _lateness_mean = 0.;
+    _lateness_m2 = 0.;
+}
+
+void periodic_worker::_tick() {
+    if (!_wait_until(_next_deadline)) {
+        // Let the worker act on the interruption
+        return;
+    }
+
+    const auto start = clock::now();
+    _task();
+    const auto end = clock::now();
+
+    const auto lateness = start - _next_deadline;
+    _next_deadline += _period;
+
+    std::size_t skipped = 0;
+    const bool overrun = end > _next_deadline;
+    if (overrun && _policy == overrun_policy::skip) {
+        // Move on to the first deadline still to come
+        const auto missed = static_cast<std::size_t>((end - _next_deadline) / _period) + 1;
+        _next_deadline += static_cast<clock::rep>(missed) * _period;
+        skipped = missed;
+    }
+
+    auto l = std::unique_lock<std::mutex>(_mutex_stats);
+    ++_stats.iterations;
+    if (overrun) {
+        ++_stats.overruns;
+    }
+    _stats.skipped += skipped;
+
+    if (_stats.iterations == 1) {
+        _stats.min_lateness = lateness;
+        _stats.max_lateness = lateness;
+    } else {
+        _stats.min_lateness = std::min(_stats.min_lateness, lateness);
+        _stats.max_lateness = std::max(_stats.max_lateness, lateness);
+    }
+
+    // Welford's online algorithm, which does not lose precision over long
+    // runs the way a sum of squares would
+    const auto value = static_cast<double>(lateness.count());
+    const double delta = value - _lateness_mean;
+    _lateness_mean += delta / static_cast<double>(_stats.iterations);
+    _lateness_m2 += delta * (value - _lateness_mean);
+}
+
+bool periodic_worker::_wait_until(clock::time_point deadline) {
+    // Sleep through most of the wait, waking up early enough to spin
+    // through the rest if asked to
+    const auto wake_up = deadline - _spin_threshold;
+    while (clock::now() < wake_up) {
+        if (_interrupted.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        // Either the wake-up time or an interruption, possibly a stale one
+        _sem_interrupt.try_acquire_until(wake_up);
+    }
+
+    while (clock::now() < deadline) {
+        if (_interrupted.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // Let other threads on the same core through, without giving up on
+        // the deadline
+        std::this_thread::yield();
+    }
+
+    return !_interrupted.load(std::memory_order_acquire);
+}
+
+void periodic_worker::_interrupt() noexcept {
+    // Only the first of consecutive interruptions needs to wake the worker
+    if (!_interrupted.exchange(true, std::memory_order_acq_rel)) {
+        _sem_interrupt.release();
+    }
+}
+
+void periodic_worker::finalize() {
+    _worker.finalize();
+    _interrupt();
+}
+
+bool periodic_worker::finalized() {
+    return _worker.finalized();
+}
+
+void periodic_worker::wait_until_finalized(bool finalize_now) {
+    if (finalize_now) {
+        finalize();
+    }
+
+    _worker.wait_until_finalized(false);
+}
+
+void periodic_worker::pause() {
+    _worker.pause();
+    _interrupt();
+}
+
+bool periodic_worker::paused() {
+    return _worker.paused();
+}
+
+void periodic_worker::wait_until_paused(bool pause_now) {
+    if (pause_now) {
+        pause();
+    }
+
+    _worker.wait_until_paused(false);
+}
+
+void periodic_worker::run() {
+    // Drop the release of a past interruption the worker did not sleep
+    // through, sparing it a spurious wake-up
+    while (_sem_interrupt.try_acquire()) {
+    }
+    _interrupted.store(false, std::memory_order_release);
+    _worker.run();
+}
+
+bool periodic_worker::running() {
+    return _worker.running();
+}
+
+void periodic_worker::wait_until_running(bool run_now) {
+    if (run_now) {
+        run();
+    }
+
+    _worker.wait_until_running(false);
+}
+
+} // namespace tools
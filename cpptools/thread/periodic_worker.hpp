@@ -0,0 +1,178 @@
+#ifndef CPPTOOLS_THREAD_PERIODIC_WORKER_HPP
+#define CPPTOOLS_THREAD_PERIODIC_WORKER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <semaphore>
+
+#include <cpptools/api.hpp>
+#include <cpptools/thread/interruptible.hpp>
+#include <cpptools/thread/worker.hpp>
+
+namespace tools {
+
+/// @brief Worker running a task at a fixed rate. Deadlines are multiples of
+/// the period from the time the worker started or resumed, so that lateness
+/// of a run does not push back the next ones.
+class periodic_worker : public interruptible {
+public:
+    using clock    = std::chrono::steady_clock;
+    using task_fun = worker::task_fun;
+
+    /// @brief What to do when a run ends past the deadline of the next one.
+    enum class overrun_policy {
+        /// @brief Run the missed iterations back to back until back on
+        /// schedule.
+        catch_up,
+        /// @brief Drop the missed iterations and carry on with the next
+        /// deadline to come.
+        skip
+    };
+
+    /// @brief Timing statistics of the runs of the task.
+    struct jitter_stats {
+        /// @brief Amount of times the task ran.
+        std::size_t iterations = 0;
+
+        /// @brief Amount of runs which ended past the deadline of the next
+        /// one.
+        std::size_t overruns = 0;
+
+        /// @brief Amount of iterations dropped by the skip policy.
+        std::size_t skipped = 0;
+
+        /// @brief Smallest delay between a deadline and the start of its run.
+        clock::duration min_lateness = clock::duration::zero();
+
+        /// @brief Largest delay between a deadline and the start of its run.
+        clock::duration max_lateness = clock::duration::zero();
+
+        /// @brief Average delay between a deadline and the start of its run.
+        clock::duration mean_lateness = clock::duration::zero();
+
+        /// @brief Standard deviation of the delay between a deadline and the
+        /// start of its run.
+        clock::duration lateness_stddev = clock::duration::zero();
+    };
+
+private:
+    /// @brief Time between two consecutive deadlines.
+    clock::duration _period;
+
+    /// @brief Process (function) to execute periodically.
+    task_fun _task;
+
+    /// @brief What to do when a run ends past the deadline of the next one.
+    overrun_policy _policy;
+
+    /// @brief How long before a deadline to stop sleeping and start
+    /// spinning, trading CPU time for precision.
+    clock::duration _spin_threshold;
+
+    /// @brief Deadline of the next run, only used by the worker thread.
+    clock::time_point _next_deadline;
+
+    /// @brief Whether the worker was asked to pause or finalize, in which
+    /// case it must stop waiting for the next deadline. Checked with a
+    /// single load while spinning.
+    std::atomic<bool> _interrupted;
+
+    /// @brief Released when the worker gets interrupted, so that it can
+    /// sleep until the next deadline with a timeout, which atomic waits
+    /// lack. Spare releases only cost the worker a spurious wake-up.
+    std::counting_semaphore<> _sem_interrupt;
+
+    /// @brief Protection around the statistics.
+    std::mutex _mutex_stats;
+
+    /// @brief Statistics gathered so far, except for the mean and standard
+    /// deviation which are kept below.
+    jitter_stats _stats;
+
+    /// @brief Running mean of the lateness, in clock ticks.
+    double _lateness_mean;
+
+    /// @brief Running sum of squared differences to the mean of the
+    /// lateness, in squared clock ticks.
+    double _lateness_m2;
+
+    /// @brief Thread running the task, constructed last as it starts right
+    /// away.
+    worker _worker;
+
+    /// @brief Wait for the next deadline, then run the task and schedule the
+    /// next run.
+    void _tick();
+
+    /// @brief Wait until a point in time, sleeping then spinning.
+    /// @return Whether the point in time was reached without the worker
+    /// being interrupted.
+    bool _wait_until(clock::time_point deadline);
+
+    /// @brief Ask the worker to stop waiting for the next deadline.
+    void _interrupt() noexcept;
+
+public:
+    /// @param period Time between two consecutive runs of the task.
+    /// @param task Process (function) to execute periodically.
+    /// @param start_now Whether or not to start the process.
+    /// @param policy What to do when a run ends past the deadline of the
+    /// next one.
+    /// @param spin_threshold How long before a deadline to stop sleeping and
+    /// start spinning, zero to only sleep. Sleeping alone typically wakes up
+    /// tens of microseconds late.
+    /// @exception tools::exception::parameter::invalid_value_error The
+    /// period is zero or negative.
+    CPPTOOLS_API periodic_worker(
+        clock::duration period,
+        task_fun task,
+        bool start_now = true,
+        overrun_policy policy = overrun_policy::skip,
+        clock::duration spin_threshold = clock::duration::zero()
+    );
+    CPPTOOLS_API ~periodic_worker();
+
+    // Moving is unsafe. If moving is needed, use unique_ptr<periodic_worker>.
+    periodic_worker(periodic_worker&&) = delete;
+
+    /// @brief Get the time between two consecutive runs of the task.
+    clock::duration period() const noexcept {
+        return _period;
+    }
+
+    /// @brief Get the timing statistics of the runs so far.
+    CPPTOOLS_API jitter_stats stats();
+
+    /// @brief Forget the timing statistics of the runs so far.
+    CPPTOOLS_API void reset_stats();
+
+    /////////////////////////////////////////////
+    ///                                       ///
+    /// Methods overridden from interruptible ///
+    ///                                       ///
+    /////////////////////////////////////////////
+
+    CPPTOOLS_API virtual void finalize();
+
+    CPPTOOLS_API virtual bool finalized();
+
+    CPPTOOLS_API virtual void wait_until_finalized(bool finalize_now = true);
+
+    CPPTOOLS_API virtual void pause();
+
+    CPPTOOLS_API virtual bool paused();
+
+    CPPTOOLS_API virtual void wait_until_paused(bool pause_now = true);
+
+    CPPTOOLS_API virtual void run();
+
+    CPPTOOLS_API virtual bool running();
+
+    CPPTOOLS_API virtual void wait_until_running(bool run_now = true);
+};
+
+} // namespace tools
+
+#endif//CPPTOOLS_THREAD_PERIODIC_WORKER_HPP
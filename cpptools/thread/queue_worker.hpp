@@ -0,0 +1,211 @@
+#ifndef CPPTOOLS_THREAD_QUEUE_WORKER_HPP
+#define CPPTOOLS_THREAD_QUEUE_WORKER_HPP
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/thread/interruptible.hpp>
+#include <cpptools/thread/mpmc_queue.hpp>
+#include <cpptools/thread/spsc_ring.hpp>
+#include <cpptools/thread/worker.hpp>
+
+namespace tools {
+
+/// @brief Worker handing the items of a queue to a handler, in batches.
+/// While the queue is empty the worker spins for a while, then parks until
+/// items come in or it is asked to pause or finalize.
+/// @tparam T Type of the queued items
+/// @tparam Queue Type of the queue, such as mpmc_queue<T>, or spsc_ring<T>
+/// in which case the items are handed to the handler in place
+/// @note Several queue workers can drain the same mpmc_queue.
+template<typename T, typename Queue = mpmc_queue<T>>
+class queue_worker : public interruptible {
+public:
+    /// @brief Type of the handler, which is given the items of a batch in
+    /// the order they were popped and may move from them
+    using handler_fun = std::move_only_function<void(std::span<T>)>;
+
+    static constexpr std::size_t default_batch_size = 64;
+
+private:
+    /// @brief Whether batches can be read in place from the queue rather
+    /// than moved out of it.
+    static constexpr bool _in_place = requires (Queue& queue, std::size_t count) {
+        { queue.peek(count) } -> std::same_as<std::span<T>>;
+        queue.consume(count);
+    };
+
+    /// @brief Queue to drain.
+    Queue& _queue;
+
+    /// @brief Function to process batches of items with.
+    handler_fun _handler;
+
+    /// @brief Maximum amount of items handed to the handler at once.
+    std::size_t _batch_size;
+
+    /// @brief Items of the batch being processed, kept across batches to
+    /// reuse its storage. Unused when reading batches in place.
+    std::vector<T> _batch;
+
+    /// @brief Whether the worker was asked to pause or finalize, in which
+    /// case it must stop waiting for items.
+    std::atomic<bool> _interrupted;
+
+    /// @brief Thread draining the queue, constructed last as it starts
+    /// right away.
+    worker _worker;
+
+    /// @brief Check a batch size before the worker gets to start.
+    static std::size_t _checked_batch_size(std::size_t batch_size) {
+        if (batch_size == 0) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "batch_size", batch_size);
+        }
+
+        return batch_size;
+    }
+
+    /// @brief Process a batch of items, or wait for some if there are none.
+    void _drain() {
+        std::span<T> batch;
+        if constexpr (_in_place) {
+            batch = _queue.peek(_batch_size);
+        } else {
+            _queue.try_pop_n(std::back_inserter(_batch), _batch_size);
+            batch = _batch;
+        }
+
+        if (batch.empty()) {
+            // Return either way, so that the worker can act on interruptions
+            _queue.wait_for_items([this]{
+                return _interrupted.load(std::memory_order_relaxed);
+            });
+            return;
+        }
+
+        _handler(batch);
+
+        if constexpr (_in_place) {
+            _queue.consume(batch.size());
+        } else {
+            _batch.clear();
+        }
+    }
+
+    /// @brief Ask the worker to stop waiting for items.
+    void _interrupt() noexcept {
+        _interrupted.store(true, std::memory_order_relaxed);
+        _queue.wake_consumers();
+    }
+
+public:
+    /// @param queue Queue to drain, which must outlive the worker, and which
+    /// must not have other consumers if it is an spsc_ring.
+    /// @param handler Function to process batches of items with, which must
+    /// not throw.
+    /// @param batch_size Maximum amount of items handed to the handler at
+    /// once.
+    /// @param start_now Whether or not to start draining right away.
+    /// @exception tools::exception::parameter::invalid_value_error The
+    /// batch size is zero.
+    queue_worker(
+        Queue& queue,
+        handler_fun handler,
+        std::size_t batch_size = default_batch_size,
+        bool start_now = true
+    ) :
+        _queue(queue),
+        _handler(std::move(handler)),
+        _batch_size(_checked_batch_size(batch_size)),
+        _batch(),
+        _interrupted(!start_now),
+        _worker(
+            [this]{ _drain(); },
+            start_now,
+            // The worker starts before the constructor body would run
+            [this]{
+                if constexpr (!_in_place) {
+                    _batch.reserve(_batch_size);
+                }
+            }
+        )
+    {
+
+    }
+
+    ~queue_worker() {
+        // The worker cannot notice it is asked to finalize while parked
+        finalize();
+        _worker.wait_until_finalized(false);
+    }
+
+    queue_worker(queue_worker&&) = delete;
+
+    /////////////////////////////////////////////
+    ///                                       ///
+    /// Methods overridden from interruptible ///
+    ///                                       ///
+    /////////////////////////////////////////////
+
+    void finalize() override {
+        _worker.finalize();
+        _interrupt();
+    }
+
+    bool finalized() override {
+        return _worker.finalized();
+    }
+
+    void wait_until_finalized(bool finalize_now = true) override {
+        if (finalize_now) {
+            finalize();
+        }
+
+        _worker.wait_until_finalized(false);
+    }
+
+    void pause() override {
+        _worker.pause();
+        _interrupt();
+    }
+
+    bool paused() override {
+        return _worker.paused();
+    }
+
+    void wait_until_paused(bool pause_now = true) override {
+        if (pause_now) {
+            pause();
+        }
+
+        _worker.wait_until_paused(false);
+    }
+
+    void run() override {
+        _interrupted.store(false, std::memory_order_relaxed);
+        _worker.run();
+    }
+
+    bool running() override {
+        return _worker.running();
+    }
+
+    void wait_until_running(bool run_now = true) override {
+        if (run_now) {
+            run();
+        }
+
+        _worker.wait_until_running(false);
+    }
+};
+
+} // namespace tools
+
+#endif//CPPTOOLS_THREAD_QUEUE_WORKER_HPP
@@ -0,0 +1,332 @@
+#ifndef CPPTOOLS_THREAD_SPSC_RING_HPP
+#define CPPTOOLS_THREAD_SPSC_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/thread/event_count.hpp>
+
+namespace tools {
+
+/// @brief Bounded wait-free ring buffer between one producer thread and one
+/// consumer thread. Slots hold live objects which the producer overwrites
+/// and the consumer reads in place, so that both sides can work on batches
+/// of slots directly with reserve/commit and peek/consume.
+/// @tparam T Type of the items, which must be default constructible and
+/// move assignable
+/// @note Each side keeps its own index and a cached copy of the index of the
+/// other side on a cache line of its own, and only reloads the index of the
+/// other side once the cached copy says the ring is full or empty.
+/// @note Every publishing operation pays a fence so that parked threads can
+/// be woken up: batch operations amortize it.
+template<typename T>
+class spsc_ring {
+    static_assert(std::is_default_constructible_v<T>, "ring slots hold live objects");
+    static_assert(std::is_nothrow_move_assignable_v<T>, "items are moved in and out of slots while they are being published");
+
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+
+    /// @brief Amount of attempts blocking operations make before parking
+    static constexpr size_type default_spin_count = 1 << 8;
+
+private:
+    /// @brief Assumed cache line size, std::hardware_destructive_interference_size
+    /// not being ABI-stable
+    static constexpr size_type _cache_line = 64;
+
+    std::unique_ptr<T[]> _slots;
+    size_type _mask;
+    size_type _spin_count;
+
+    /// @brief Position of the next slot to be written, only written by the
+    /// producer
+    alignas(_cache_line) std::atomic<size_type> _tail;
+
+    /// @brief Value of _head last seen by the producer
+    size_type _cached_head;
+
+    /// @brief Position of the next slot to be read, only written by the
+    /// consumer
+    alignas(_cache_line) std::atomic<size_type> _head;
+
+    /// @brief Value of _tail last seen by the consumer
+    size_type _cached_tail;
+
+    /// @brief The consumer parks here while waiting for items
+    alignas(_cache_line) detail::event_count _not_empty;
+
+    /// @brief The producer parks here while waiting for room
+    alignas(_cache_line) detail::event_count _not_full;
+
+    /// @brief Get the amount of slots the producer can write to, reloading
+    /// the position of the consumer if fewer than wanted seem free
+    size_type _writable(size_type tail, size_type wanted) noexcept {
+        size_type free = capacity() - (tail - _cached_head);
+        if (free < wanted) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            free = capacity() - (tail - _cached_head);
+        }
+
+        return free;
+    }
+
+    /// @brief Get the amount of slots the consumer can read from, reloading
+    /// the position of the producer if fewer than wanted seem filled
+    size_type _readable(size_type head, size_type wanted) noexcept {
+        size_type filled = _cached_tail - head;
+        if (filled < wanted) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            filled = _cached_tail - head;
+        }
+
+        return filled;
+    }
+
+    /// @brief Spin for a while, then park, until an operation succeeds
+    template<typename Op>
+    void _spin_then_park(detail::event_count& event, Op&& op) {
+        for (size_type i = 0; i < _spin_count; ++i) {
+            if (op()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        event.wait_until(op);
+    }
+
+public:
+    /// @param capacity Minimum amount of items the ring can hold, rounded up
+    /// to a power of two
+    /// @param spin_count Amount of attempts blocking operations make before
+    /// parking
+    /// @exception tools::exception::parameter::invalid_value_error The
+    /// capacity is zero.
+    explicit spsc_ring(size_type capacity, size_type spin_count = default_spin_count) :
+        _slots(),
+        _mask(0),
+        _spin_count(spin_count),
+        _tail(0),
+        _cached_head(0),
+        _head(0),
+        _cached_tail(0)
+    {
+        if (capacity == 0) {
+            CPPTOOLS_THROW(exception::parameter::invalid_value_error, "capacity", capacity);
+        }
+
+        capacity = std::bit_ceil(capacity);
+        _slots = std::make_unique<T[]>(capacity);
+        _mask = capacity - 1;
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    size_type capacity() const noexcept {
+        return _mask + 1;
+    }
+
+    /// @brief Get the amount of items in the ring, which may already have
+    /// changed by the time it is returned
+    size_type size_approx() const noexcept {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        const auto diff = static_cast<std::ptrdiff_t>(tail - head);
+
+        return static_cast<size_type>(std::clamp<std::ptrdiff_t>(diff, 0, static_cast<std::ptrdiff_t>(capacity())));
+    }
+
+    /// @brief Tell whether the ring holds no items, which may already have
+    /// changed by the time it is returned
+    bool empty() const noexcept {
+        return _head.load(std::memory_order_relaxed) == _tail.load(std::memory_order_acquire);
+    }
+
+    ////////////////////////////////////////////
+    ///                                      ///
+    /// Producer side                        ///
+    ///                                      ///
+    ////////////////////////////////////////////
+
+    /// @brief Get free slots to write items to in place, before publishing
+    /// them with commit
+    /// @param count Amount of slots wanted
+    /// @return Consecutive free slots, which may be fewer than wanted if the
+    /// ring is nearly full or wraps around
+    std::span<T> reserve(size_type count) noexcept {
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        const size_type first = tail & _mask;
+        const size_type free = _writable(tail, count);
+
+        return { _slots.get() + first, std::min({ count, free, capacity() - first }) };
+    }
+
+    /// @brief Publish the first slots returned by the last call to reserve
+    /// @param count Amount of slots to publish, at most the amount reserved
+    void commit(size_type count) noexcept {
+        _tail.store(_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        _not_empty.notify();
+    }
+
+    /// @brief Push an item if there is room
+    /// @return Whether the item was pushed. It is left untouched otherwise.
+    bool try_push(T&& value) noexcept {
+        auto slots = reserve(1);
+        if (slots.empty()) {
+            return false;
+        }
+
+        slots[0] = std::move(value);
+        commit(1);
+
+        return true;
+    }
+
+    /// @brief Push a copy of an item if there is room
+    /// @return Whether the item was pushed
+    bool try_push(const T& value) {
+        auto slots = reserve(1);
+        if (slots.empty()) {
+            return false;
+        }
+
+        slots[0] = value;
+        commit(1);
+
+        return true;
+    }
+
+    /// @brief Push an item, waiting for room if the ring is full
+    void push(T value) {
+        _spin_then_park(_not_full, [&]{ return try_push(std::move(value)); });
+    }
+
+    /// @brief Push up to some amount of items at once
+    /// @param first Iterator to the first item to push, which can be a move
+    /// iterator
+    /// @param count Amount of items to push
+    /// @return The amount of items pushed
+    template<std::input_iterator It>
+    size_type push_n(It first, size_type count) {
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        const size_type pushed = std::min(count, _writable(tail, count));
+
+        for (size_type i = 0; i < pushed; ++i, ++first) {
+            _slots[(tail + i) & _mask] = *first;
+        }
+
+        if (pushed != 0) {
+            commit(pushed);
+        }
+
+        return pushed;
+    }
+
+    ////////////////////////////////////////////
+    ///                                      ///
+    /// Consumer side                        ///
+    ///                                      ///
+    ////////////////////////////////////////////
+
+    /// @brief Get items to read in place, before releasing their slots with
+    /// consume
+    /// @param count Maximum amount of items wanted
+    /// @return Consecutive items, oldest first, which may be fewer than
+    /// wanted if the ring wraps around. The consumer may move from them.
+    std::span<T> peek(size_type count) noexcept {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        const size_type first = head & _mask;
+        const size_type filled = _readable(head, count);
+
+        return { _slots.get() + first, std::min({ count, filled, capacity() - first }) };
+    }
+
+    /// @brief Release the slots of the first items returned by the last call
+    /// to peek
+    /// @param count Amount of items to release, at most the amount peeked
+    void consume(size_type count) noexcept {
+        _head.store(_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        _not_full.notify();
+    }
+
+    /// @brief Pop the oldest item if there is one
+    std::optional<T> try_pop() {
+        auto items = peek(1);
+        if (items.empty()) {
+            return std::nullopt;
+        }
+
+        std::optional<T> result(std::move(items[0]));
+        consume(1);
+
+        return result;
+    }
+
+    /// @brief Pop the oldest item, waiting for one if the ring is empty
+    T pop() {
+        std::optional<T> result;
+        _spin_then_park(_not_empty, [&]{
+            result = try_pop();
+            return result.has_value();
+        });
+
+        return std::move(*result);
+    }
+
+    /// @brief Pop up to some amount of items at once, oldest first
+    /// @param out Output iterator the popped items are moved to
+    /// @param max_count Maximum amount of items to pop
+    /// @return The amount of items popped
+    /// @note If writing to the output iterator throws, no item is popped, and
+    /// the items written so far are left moved-from in the ring.
+    template<typename OutputIt>
+    size_type pop_n(OutputIt out, size_type max_count) {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        const size_type popped = std::min(max_count, _readable(head, max_count));
+
+        for (size_type i = 0; i < popped; ++i) {
+            *out = std::move(_slots[(head + i) & _mask]);
+            ++out;
+        }
+
+        if (popped != 0) {
+            consume(popped);
+        }
+
+        return popped;
+    }
+
+    /// @brief Wait until the ring seems not empty, or until a condition holds
+    /// @param interrupted Condition to stop waiting on, which must be made to
+    /// hold before calling wake_consumers
+    template<typename Pred>
+    void wait_for_items(Pred&& interrupted) {
+        _spin_then_park(_not_empty, [&]{
+            return !empty() || interrupted();
+        });
+    }
+
+    /// @brief Wake up the consumer if waiting for items, so that it checks
+    /// its interruption condition
+    void wake_consumers() noexcept {
+        _not_empty.notify();
+    }
+};
+
+} // namespace tools
+
+#endif//CPPTOOLS_THREAD_SPSC_RING_HPP
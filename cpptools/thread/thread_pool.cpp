@@ -0,0 +1,174 @@
+#include "thread_pool.hpp"
+
+namespace tools {
+
+namespace {
+
+/// @brief Pool the calling thread belongs to, if any
+thread_local const thread_pool* current_pool = nullptr;
+
+/// @brief Index of the calling thread in its pool
+thread_local std::size_t current_index = 0;
+
+}
+
+thread_pool::thread_pool(std::size_t thread_count, std::size_t spin_count) :
+    _spin_count(spin_count),
+    _next_queue(0),
+    _epoch(0),
+    _sleepers(0),
+    _stopping(false)
+{
+    thread_count = std::max<std::size_t>(1, thread_count);
+
+    _queues.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        _queues.push_back(std::make_unique<_queue>());
+    }
+
+    // All queues exist before the first thread starts looking for work
+    _threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        _threads.emplace_back([this, i]{
+            _work(i);
+        });
+    }
+}
+
+thread_pool::~thread_pool() {
+    _stopping.store(true);
+    _epoch.fetch_add(1);
+    _epoch.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void thread_pool::post(task_type f) {
+    _push(std::move(f));
+}
+
+bool thread_pool::run_pending_task() {
+    const bool own = current_pool == this;
+    const std::size_t start = own ? current_index : _next_queue.load(std::memory_order_relaxed);
+
+    task_type task;
+    if (!_find_task(start % _queues.size(), task)) {
+        return false;
+    }
+
+    task();
+    return true;
+}
+
+void thread_pool::_push(task_type task) {
+    const std::size_t index = current_pool == this
+        ? current_index
+        : _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+
+    {
+        auto& queue = *_queues[index];
+        std::scoped_lock lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queue.size.fetch_add(1);
+    }
+
+    // Parking threads register as sleepers before their last look at the
+    // queues, so either they see this task or this sees them
+    _epoch.fetch_add(1);
+    if (_sleepers.load() != 0) {
+        _epoch.notify_one();
+    }
+}
+
+bool thread_pool::_take(std::size_t queue_index, bool own, task_type& task) {
+    auto& queue = *_queues[queue_index];
+
+    // Idle threads look at every queue many times over, only contend for
+    // those which have tasks
+    if (queue.size.load() == 0) {
+        return false;
+    }
+
+    std::scoped_lock lock(queue.mutex);
+
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    // The owner takes the newest task, which is likely still in cache,
+    // thieves take the oldest one, which is likely to spawn more work
+    if (own) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    queue.size.fetch_sub(1);
+
+    return true;
+}
+
+bool thread_pool::_find_task(std::size_t queue_index, task_type& task) {
+    const bool own = current_pool == this && current_index == queue_index;
+    if (_take(queue_index, own, task)) {
+        return true;
+    }
+
+    for (std::size_t i = 1; i < _queues.size(); ++i) {
+        if (_take((queue_index + i) % _queues.size(), false, task)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void thread_pool::_work(std::size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    task_type task;
+    std::size_t failed_attempts = 0;
+
+    while (true) {
+        if (_find_task(index, task)) {
+            failed_attempts = 0;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        if (++failed_attempts < _spin_count) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Out of work for a while: park until the epoch moves
+        const std::uint32_t epoch = _epoch.load();
+        _sleepers.fetch_add(1);
+
+        if (_find_task(index, task)) {
+            _sleepers.fetch_sub(1);
+            failed_attempts = 0;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        // Only exit once all queues are empty, so that submitted tasks
+        // always run
+        if (_stopping.load()) {
+            _sleepers.fetch_sub(1);
+            return;
+        }
+
+        _epoch.wait(epoch);
+        _sleepers.fetch_sub(1);
+        failed_attempts = 0;
+    }
+}
+
+} // namespace tools
@@ -0,0 +1,228 @@
+#ifndef CPPTOOLS_THREAD_THREAD_POOL_HPP
+#define CPPTOOLS_THREAD_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cpptools/api.hpp>
+
+namespace tools {
+
+/// @brief Pool of threads running many short tasks across all cores.
+/// Every thread owns a deque of tasks: it runs its own tasks newest first
+/// and, once out of tasks, steals the oldest tasks of other threads. Idle
+/// threads spin for a while looking for work, then park until some is
+/// submitted.
+class thread_pool {
+public:
+    using task_type = std::move_only_function<void()>;
+
+    /// @brief Amount of attempts an idle thread makes at finding work before
+    /// parking
+    static constexpr std::size_t default_spin_count = 1 << 10;
+
+private:
+    /// @brief Tasks of a thread, alone on its cache line so that threads
+    /// taking their own tasks do not contend with one another
+    /// @note std::hardware_destructive_interference_size is not ABI-stable,
+    /// the common cache line size is used instead.
+    struct alignas(64) _queue {
+        std::mutex mutex;
+        std::deque<task_type> tasks;
+
+        /// @brief Amount of tasks, readable without locking so that idle
+        /// threads only lock queues which have tasks to take
+        std::atomic<std::size_t> size = 0;
+    };
+
+    /// @brief Task queues, one per thread, which never move so that threads
+    /// can keep pointers to them
+    std::vector<std::unique_ptr<_queue>> _queues;
+
+    /// @brief Threads of the pool
+    std::vector<std::thread> _threads;
+
+    /// @brief Amount of attempts an idle thread makes at finding work before
+    /// parking
+    std::size_t _spin_count;
+
+    /// @brief Queue in which the next task submitted from outside the pool
+    /// is pushed
+    std::atomic<std::size_t> _next_queue;
+
+    /// @brief Incremented whenever work is submitted, parked threads wait on
+    /// it to change
+    std::atomic<std::uint32_t> _epoch;
+
+    /// @brief Amount of threads parked or about to park
+    std::atomic<std::size_t> _sleepers;
+
+    /// @brief Whether the threads should exit once out of tasks
+    std::atomic<bool> _stopping;
+
+    /// @brief Push a task in the queue of the calling thread if it belongs to
+    /// this pool, in another queue otherwise, and wake up a parked thread
+    CPPTOOLS_API void _push(task_type task);
+
+    /// @brief Take a task from a queue, the newest one if the queue belongs
+    /// to the calling thread, the oldest one otherwise
+    /// @return Whether a task was taken
+    bool _take(std::size_t queue_index, bool own, task_type& task);
+
+    /// @brief Take a task from the queue of a thread, or steal one from the
+    /// other queues
+    /// @return Whether a task was found
+    bool _find_task(std::size_t queue_index, task_type& task);
+
+    /// @brief Run tasks in a thread of the pool until it is stopped
+    void _work(std::size_t index);
+
+public:
+    /// @param thread_count Amount of threads in the pool, at least one
+    /// @param spin_count Amount of attempts an idle thread makes at finding
+    /// work before parking
+    CPPTOOLS_API explicit thread_pool(
+        std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency()),
+        std::size_t spin_count = default_spin_count
+    );
+
+    /// @brief Run all tasks submitted so far, then join the threads
+    CPPTOOLS_API ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /// @brief Get the amount of threads in the pool
+    std::size_t size() const noexcept {
+        return _threads.size();
+    }
+
+    /// @brief Run a callable in a thread of the pool
+    /// @param f Callable to run, which may be move-only
+    /// @return A future holding the result of the callable, or the exception
+    /// it threw
+    /// @note Tasks submitted from a thread of the pool are run newest first
+    /// by that thread, unless another thread steals them.
+    template<typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>&>> submit(F&& f) {
+        using result_type = std::invoke_result_t<std::decay_t<F>&>;
+
+        std::packaged_task<result_type()> task(std::forward<F>(f));
+        auto future = task.get_future();
+        _push(std::move(task));
+
+        return future;
+    }
+
+    /// @brief Run a callable without keeping track of its completion
+    /// @param f Callable to run, which may be move-only and must not throw
+    CPPTOOLS_API void post(task_type f);
+
+    /// @brief Run a task from the pool on the calling thread, if any is
+    /// pending
+    /// @return Whether a task was run
+    /// @note Threads waiting for tasks of the pool can call this in the
+    /// meantime, so that the pool does not run out of threads.
+    CPPTOOLS_API bool run_pending_task();
+
+    /// @brief Call a function for every index of a range, spreading the
+    /// indices over the threads of the pool and the calling thread
+    /// @param first First index of the range
+    /// @param last Index past the last one of the range
+    /// @param f Function to be called with every index, in unspecified order
+    /// @param grain Amount of consecutive indices handed out at once, chosen
+    /// so that every thread gets a few chunks if 0
+    /// @exception The first exception thrown by \c f is rethrown once all
+    /// chunks which were started are done. Chunks not started by then are
+    /// skipped.
+    /// @note The calling thread takes part in the work and runs other tasks
+    /// of the pool while waiting, so this can be called from within a task.
+    template<typename F>
+    void parallel_for(std::size_t first, std::size_t last, F&& f, std::size_t grain = 0) {
+        if (first >= last) {
+            return;
+        }
+
+        const std::size_t count = last - first;
+        if (grain == 0) {
+            grain = std::max<std::size_t>(1, count / (4 * (size() + 1)));
+        }
+
+        const std::size_t chunk_count = (count + grain - 1) / grain;
+
+        struct shared_state {
+            std::atomic<std::size_t> next_chunk = 0;
+            std::atomic<std::size_t> pending_helpers;
+            std::atomic<bool> failed = false;
+            std::exception_ptr error;
+            std::mutex error_mutex;
+        } state;
+
+        auto run_chunks = [&state, &f, first, last, grain, chunk_count]() {
+            while (!state.failed.load(std::memory_order_relaxed)) {
+                const std::size_t chunk = state.next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= chunk_count) {
+                    return;
+                }
+
+                const std::size_t begin = first + chunk * grain;
+                const std::size_t end   = std::min(last, begin + grain);
+
+                try {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        f(i);
+                    }
+                } catch (...) {
+                    std::scoped_lock lock(state.error_mutex);
+                    if (!state.error) {
+                        state.error = std::current_exception();
+                    }
+                    state.failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // the calling thread runs chunks too, helpers are only needed for
+        // the other ones
+        const std::size_t helper_count = std::min(size(), chunk_count - 1);
+        state.pending_helpers.store(helper_count, std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < helper_count; ++i) {
+            post([&state, &run_chunks]() {
+                run_chunks();
+                state.pending_helpers.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        run_chunks();
+
+        // helpers reference the state on this stack frame: wait for all of
+        // them, running tasks of the pool in the meantime so that helpers
+        // queued behind the calling thread get to run
+        while (state.pending_helpers.load(std::memory_order_acquire) != 0) {
+            if (!run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+    }
+};
+
+} // namespace tools
+
+#endif//CPPTOOLS_THREAD_THREAD_POOL_HPP
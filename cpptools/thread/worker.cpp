@@ -10,11 +10,7 @@ worker::worker(
     task_fun on_resume,
     task_fun on_pause
 ) :
-    _exit(false),
-    _execute(start_now),
-    _finalized(false),
-    _paused(false),
-    _running(false),
+    _state(start_now ? _execute : 0u),
     _task(std::move(task)),
     _on_start(std::move(on_start)),
     _on_finalize(std::move(on_finalize)),
@@ -31,20 +27,39 @@ worker::worker(
 }
 
 worker::~worker() {
-    if (!_exit) finalize();
+    if (!(_state.load() & _exit)) finalize();
     _thread.get();
 }
 
+void worker::_set(std::uint32_t bits) noexcept {
+    _state.fetch_or(bits, std::memory_order_acq_rel);
+    // The worker and any amount of observers may wait on the state word,
+    // each for a different flag
+    _state.notify_all();
+}
+
+void worker::_clear(std::uint32_t bits) noexcept {
+    _state.fetch_and(~bits, std::memory_order_acq_rel);
+    _state.notify_all();
+}
+
+std::uint32_t worker::_wait_for_any(std::uint32_t bits) noexcept {
+    auto state = _state.load(std::memory_order_acquire);
+    while (!(state & bits)) {
+        _state.wait(state, std::memory_order_acquire);
+        state = _state.load(std::memory_order_acquire);
+    }
+
+    return state;
+}
+
 void worker::finalize() {
-    auto l = std::unique_lock<std::mutex>(_mutex_execute);
-    _exit = true;
-    // Notify thread to resume execution, only to immediately terminate
-    _sem_execute.notify_all();
+    // Wake the thread up if paused, only for it to immediately terminate
+    _set(_exit);
 }
 
 bool worker::finalized() {
-    auto l = std::unique_lock<std::mutex>(_mutex_finalized);
-    return _finalized;
+    return _state.load(std::memory_order_acquire) & _finalized;
 }
 
 void worker::wait_until_finalized(bool finalize_now) {
@@ -52,23 +67,17 @@ void worker::wait_until_finalized(bool finalize_now) {
         finalize();
     }
 
-    auto l = std::unique_lock<std::mutex>(_mutex_finalized);
     // Wait until the thread says it finalized itself
-    _sem_finalized.wait(l, [&]{
-        return _finalized;
-    });
+    _wait_for_any(_finalized);
 }
 
 void worker::pause() {
-    auto l = std::unique_lock<std::mutex>(_mutex_execute);
-    _execute = false;
-    // Don't notify the thread, as the waiting condition is not going
-    // away by setting _execute to false.
+    // Nobody waits for _execute to be cleared, no need to notify
+    _state.fetch_and(~std::uint32_t{ _execute }, std::memory_order_acq_rel);
 }
 
 bool worker::paused() {
-    auto l = std::unique_lock<std::mutex>(_mutex_pause);
-    return _paused;
+    return _state.load(std::memory_order_acquire) & _paused;
 }
 
 void worker::wait_until_paused(bool pause_now) {
@@ -76,23 +85,16 @@ void worker::wait_until_paused(bool pause_now) {
         pause();
     }
 
-    auto l = std::unique_lock<std::mutex>(_mutex_pause);
     // Wait until the thread says it paused
-    _sem_pause.wait(l, [&]{
-        return _paused;
-    });
+    _wait_for_any(_paused);
 }
 
 void worker::run() {
-    auto l = std::unique_lock<std::mutex>(_mutex_execute);
-    _execute = true;
-    // Notify thread to resume execution
-    _sem_execute.notify_one();
+    _set(_execute);
 }
 
 bool worker::running() {
-    auto l = std::unique_lock<std::mutex>(_mutex_run);
-    return _running;
+    return _state.load(std::memory_order_acquire) & _running;
 }
 
 void worker::wait_until_running(bool run_now) {
@@ -100,67 +102,46 @@ void worker::wait_until_running(bool run_now) {
         run();
     }
 
-    auto l = std::unique_lock<std::mutex>(_mutex_run);
     // Wait until the thread says it resumed
-    _sem_running.wait(l, [&]{
-        return _running;
-    });
+    _wait_for_any(_running);
 }
 
 void worker::_work() {
-    bool stop_execution = false;
     bool was_running_before = false;
 
     _on_start();
     while(true) {
-        auto l = std::unique_lock<std::mutex>(_mutex_execute);
+        // Hot path: a single relaxed load while nothing changes
+        auto state = _state.load(std::memory_order_relaxed);
+        if (was_running_before && (state & (_exit | _execute)) == _execute) {
+            _task();
+            continue;
+        }
+
+        // Something changed, synchronize with whoever changed it
+        state = _state.load(std::memory_order_acquire);
 
         // If asked to pause...
-        if (!_exit && !_execute) {
-            // Set the pause flag to true, notify awaiting threads
-            // Also set the running flag to false
-            {
-                auto p = std::unique_lock<std::mutex>(_mutex_pause);
-                _paused = true;
-                _sem_pause.notify_all();
-                p.unlock();
-
-                auto r = std::unique_lock<std::mutex>(_mutex_run);
-                _running = false;
-            }
+        if (!(state & (_exit | _execute))) {
+            // Set the pause flag, clear the running flag and notify
+            // awaiting threads
+            _state.fetch_and(~std::uint32_t{ _running }, std::memory_order_acq_rel);
+            _set(_paused);
 
             _on_pause();
 
-            // Wait for resume signal
-            _sem_execute.wait(l, [&]{
-                return _execute || _exit;
-            });
-
-            // Signify whether to continue or to stop execution.
-            stop_execution = _exit;
-            l.unlock();
-
-            // Reset pause flag
-            {
-                auto p = std::unique_lock<std::mutex>(_mutex_pause);
-                _paused = false;
-            }
+            // Wait for resume signal, then reset the pause flag
+            state = _wait_for_any(_execute | _exit);
+            _clear(_paused);
             was_running_before = false;
-        } else if (_exit) {
-            stop_execution = _exit;
-            l.unlock();
-        } else {
-            l.unlock();
         }
 
-        if (stop_execution) {
+        if (state & _exit) {
             // Exit loop if appropriate
             break;
         } else if (!was_running_before) {
             // Otherwise notify continuation of thread
-            auto r = std::unique_lock<std::mutex>(_mutex_run);
-            _running = true;
-            _sem_running.notify_all();
+            _set(_running);
             _on_resume();
             was_running_before = true;
         }
@@ -170,9 +151,7 @@ void worker::_work() {
     }
     _on_finalize();
 
-    auto f = std::unique_lock<std::mutex>(_mutex_finalized);
-    _finalized = true;
-    _sem_finalized.notify_all();
+    _set(_finalized);
 }
 
-} // namespace tools
\ No newline at end of file
+} // namespace tools
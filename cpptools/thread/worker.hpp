@@ -1,9 +1,10 @@
 #ifndef CPPTOOLS_THREAD_WORKER_HPP
 #define CPPTOOLS_THREAD_WORKER_HPP
 
-#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <future>
-#include <mutex>
 
 #include <cpptools/api.hpp>
 #include <cpptools/thread/interruptible.hpp>
@@ -12,65 +13,47 @@ namespace tools {
 
 class worker : public interruptible {
 public:
-    using task_fun = void (*)(void);
+    /// @brief Type of the task and hooks. Callables may hold state and be
+    /// move-only; small ones, such as lambdas capturing a couple of
+    /// pointers, are stored inline without allocating.
+    using task_fun = std::move_only_function<void()>;
 private:
-    /// @brief Protection around the execution flow flags (_execute and _exit).
-    std::mutex _mutex_execute;
-
-    /// @brief Protection around the _finalized flag.
-    std::mutex _mutex_finalized;
-
-    /// @brief Protection around the _pause flag.
-    std::mutex _mutex_pause;
-
-    /// @brief Protection around the _running flag.
-    std::mutex _mutex_run;
-
-    /// @brief Semaphore to wait by in order to control the execution flow.
-    std::condition_variable _sem_execute;
-
-    /// @brief Semaphore to wait by in order to know whether the thread
-    /// is finalized.
-    std::condition_variable _sem_finalized;
-
-    /// @brief Semaphore to wait by in order to know whether the thread
-    /// is paused.
-    std::condition_variable _sem_pause;
-
-    /// @brief Semaphore to wait by in order to know whether the thread
-    /// is running.
-    std::condition_variable _sem_running;
+    /// @brief Bits of the state word of the worker.
+    enum _state_bit : std::uint32_t {
+        /// @brief Stop processing and finalize.
+        _exit       = 1u << 0,
+        /// @brief Whether to keep executing or to halt.
+        _execute    = 1u << 1,
+        /// @brief Whether or not the thread is finalized.
+        _finalized  = 1u << 2,
+        /// @brief Whether or not the thread is paused.
+        _paused     = 1u << 3,
+        /// @brief Whether or not the thread is running.
+        _running    = 1u << 4
+    };
 
     ///                          ///    \\\
     ///                         /// !!!! \\\
     ///                        ///        \\\
     ///
     /// _exit and _execute are the only flags which control the execution
-    /// flow of the threaded process. All other boolean flags are only meant
-    /// to be informative.
+    /// flow of the threaded process. All other flags are only meant to be
+    /// informative.
 
-    /// @brief Stop processing and finalize.
-    bool _exit;
+    /// @brief All flags of the worker in a single word, so that the loop
+    /// only needs one load per iteration to know whether to keep going.
+    /// Threads waiting for a flag to change wait on the word itself.
+    std::atomic<std::uint32_t> _state;
 
-    /// @brief Whether to keep executing or to halt.
-    bool _execute;
+    /// @brief Set flags of the state word and wake up threads waiting on it.
+    void _set(std::uint32_t bits) noexcept;
 
-    /// @brief Whether or not the thread is finalized.
-    bool _finalized;
+    /// @brief Clear flags of the state word and wake up threads waiting on it.
+    void _clear(std::uint32_t bits) noexcept;
 
-    /// @brief Whether or not the thread is paused.
-    bool _paused;
-
-    /// @brief Whether or not the thread is running.
-    bool _running;
-
-    ///                          ///    \\\
-    ///                         /// !!!! \\\
-    ///                        ///        \\\
-    ///
-    /// _exit and _execute are the only flags which control the execution
-    /// flow of the threaded process. All other boolean flags are only meant
-    /// to be informative.
+    /// @brief Hang the calling thread until any of some flags is set.
+    /// @return The state word in which one of the flags was seen set.
+    std::uint32_t _wait_for_any(std::uint32_t bits) noexcept;
 
     /// @brief Process (function) to execute in a loop.
     task_fun _task;
@@ -1,6 +1,7 @@
 #ifndef CPPTOOLS_UTILITY_CONCEPTS_HPP
 #define CPPTOOLS_UTILITY_CONCEPTS_HPP
 
+#include <functional>
 #include <type_traits>
 
 namespace tools {
@@ -22,6 +23,10 @@ concept arithmetic = std::is_arithmetic_v<T>;
 template<typename T>
 concept numeric = arithmetic<T> || enumeration<T>;
 
+/// @brief Satisfied if values of type T can be hashed with std::hash
+template<typename T>
+concept hashable = requires (const T& v) { std::hash<T>{}(v); };
+
 template<typename T>
 concept implicit_lifetime_class = std::is_trivially_destructible_v<std::remove_cv_t<T>> &&
     (std::is_trivially_default_constructible_v<std::remove_cv_t<T>> || std::is_aggregate_v<std::remove_cv_t<T>>);
@@ -0,0 +1,124 @@
+#include <utility>
+
+#include "mapped_file.hpp"
+
+#include <cpptools/exception/exception.hpp>
+#include <cpptools/exception/io_exception.hpp>
+
+#ifdef _WIN32
+# include <cpptools/platform/sane_windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace tools {
+
+mapped_file::mapped_file(const std::filesystem::path& path) :
+    _data(nullptr),
+    _size(0)
+{
+    if (!std::filesystem::exists(path)) {
+        CPPTOOLS_THROW(exception::io::file_not_found_error, path);
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        CPPTOOLS_THROW(exception::io::access_denied_error, path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        CPPTOOLS_THROW(exception::io::access_denied_error, path);
+    }
+
+    if (size.QuadPart != 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = (mapping != nullptr)
+            ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+            : nullptr;
+
+        // the view keeps the mapping alive
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+
+        if (view == nullptr) {
+            CloseHandle(file);
+            CPPTOOLS_THROW(exception::io::access_denied_error, path);
+        }
+
+        _data = static_cast<const std::byte*>(view);
+        _size = static_cast<std::size_t>(size.QuadPart);
+    }
+
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        CPPTOOLS_THROW(exception::io::access_denied_error, path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) == -1) {
+        ::close(fd);
+        CPPTOOLS_THROW(exception::io::access_denied_error, path);
+    }
+
+    if (info.st_size != 0) {
+        void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            ::close(fd);
+            CPPTOOLS_THROW(exception::io::access_denied_error, path);
+        }
+
+        _data = static_cast<const std::byte*>(view);
+        _size = static_cast<std::size_t>(info.st_size);
+    }
+
+    // the mapping keeps the file alive
+    ::close(fd);
+#endif
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept :
+    _data(std::exchange(other._data, nullptr)),
+    _size(std::exchange(other._size, 0))
+{
+
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+    if (&other != this) {
+        _unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+
+    return *this;
+}
+
+mapped_file::~mapped_file() {
+    _unmap();
+}
+
+void mapped_file::_unmap() noexcept {
+    if (_data == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+#else
+    ::munmap(const_cast<std::byte*>(_data), _size);
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+} // namespace tools
@@ -0,0 +1,56 @@
+#ifndef CPPTOOLS_UTILITY_MAPPED_FILE_HPP
+#define CPPTOOLS_UTILITY_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+#include <cpptools/api.hpp>
+
+namespace tools {
+
+/// @brief Read-only memory mapping of a whole file
+/// @note The mapping does not move along with instances of this class: spans
+/// obtained from \c bytes() remain valid across moves, until the instance
+/// holding the mapping is destroyed.
+class mapped_file {
+public:
+    /// @param path Path to the file to map
+    /// @exception exception::io::file_not_found_error if the file does not
+    /// exist
+    /// @exception exception::io::access_denied_error if the file could not be
+    /// opened or mapped
+    CPPTOOLS_API explicit mapped_file(const std::filesystem::path& path);
+
+    CPPTOOLS_API mapped_file(mapped_file&& other) noexcept;
+    CPPTOOLS_API mapped_file& operator=(mapped_file&& other) noexcept;
+
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file& operator=(const mapped_file& other) = delete;
+
+    CPPTOOLS_API ~mapped_file();
+
+    /// @brief Get the contents of the file
+    std::span<const std::byte> bytes() const noexcept {
+        return { _data, _size };
+    }
+
+    /// @brief Get the size of the file in bytes
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+private:
+    /// @brief Start of the mapping, null if the file is empty
+    const std::byte* _data;
+
+    /// @brief Size of the mapping in bytes
+    std::size_t _size;
+
+    /// @brief Release the mapping, if any
+    void _unmap() noexcept;
+};
+
+} // namespace tools
+
+#endif//CPPTOOLS_UTILITY_MAPPED_FILE_HPP
@@ -0,0 +1,146 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/container/concurrent_tree.hpp>
+#include <cpptools/container/tree.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+constexpr char BENCHMARK_TAGS[] = "[container][concurrent_tree][.benchmark]";
+
+namespace tools::test {
+
+namespace {
+
+constexpr std::size_t Depth         = 5;
+constexpr std::size_t FanOut        = 8;
+constexpr int         LookupsPerRun = 10'000;
+
+unsigned reader_count() {
+    return std::max(2u, std::thread::hardware_concurrency());
+}
+
+void fill_persistent(persistent_tree<int>& t, persistent_tree<int>::path& p, std::size_t depth) {
+    if (depth == Depth) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < FanOut; ++i) {
+        p.push_back(t.emplace_node(p, static_cast<int>(i)).back());
+        fill_persistent(t, p, depth + 1);
+        p.pop_back();
+    }
+}
+
+void fill_tree(tree<int>& t, tree<int>::node_handle_t n, std::size_t depth) {
+    if (depth == Depth) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < FanOut; ++i) {
+        fill_tree(t, t.emplace_node(n, static_cast<int>(i)), depth + 1);
+    }
+}
+
+/// @brief Run readers doing root-to-leaf lookups along random paths, each in
+/// its own thread, while another thread keeps editing the tree
+/// @return Sum of the values found, so that lookups are not optimized away
+template<typename Lookup, typename Edit>
+long run_readers_against_writer(Lookup lookup, Edit edit) {
+    std::atomic<bool> stop = false;
+    std::thread writer([&stop, &edit]() {
+        std::mt19937 rng(0);
+        while (!stop.load(std::memory_order_relaxed)) {
+            edit(rng);
+        }
+    });
+
+    std::atomic<long> total = 0;
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < reader_count(); ++r) {
+        readers.emplace_back([&total, &lookup, r]() {
+            std::mt19937 rng(r + 1);
+            total += lookup(rng);
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    stop = true;
+    writer.join();
+
+    return total;
+}
+
+} // namespace
+
+TEST_CASE( "Concurrent tree reader throughput under a concurrent writer", BENCHMARK_TAGS ) {
+    concurrent_tree<int> concurrent;
+    concurrent.update([](persistent_tree<int>& staged) {
+        staged.emplace_node({}, 0);
+        persistent_tree<int>::path p;
+        fill_persistent(staged, p, 0);
+    });
+
+    tree<int> locked;
+    fill_tree(locked, locked.emplace_node(locked.root(), 0), 0);
+    std::shared_mutex mutex;
+
+    BENCHMARK( "concurrent_tree, lock-free readers" ) {
+        return run_readers_against_writer(
+            [&concurrent](std::mt19937& rng) {
+                auto reader = concurrent.make_reader();
+                long sum = 0;
+                for (int i = 0; i < LookupsPerRun; ++i) {
+                    auto version = reader.read();
+                    auto n = version->root();
+                    for (std::size_t d = 0; d < Depth; ++d) {
+                        n = n.child(rng() % n.child_count());
+                        sum += *n;
+                    }
+                }
+                return sum;
+            },
+            [&concurrent](std::mt19937& rng) {
+                concurrent.update([&rng](persistent_tree<int>& staged) {
+                    auto p = staged.emplace_node({ rng() % FanOut, rng() % FanOut }, 0);
+                    staged.erase_subtree(p);
+                    staged.assign({ rng() % FanOut }, static_cast<int>(rng() % 100));
+                });
+            }
+        );
+    };
+
+    BENCHMARK( "tree behind a shared_mutex" ) {
+        return run_readers_against_writer(
+            [&locked, &mutex](std::mt19937& rng) {
+                long sum = 0;
+                for (int i = 0; i < LookupsPerRun; ++i) {
+                    std::shared_lock lock(mutex);
+                    auto n = std::as_const(locked).root();
+                    for (std::size_t d = 0; d < Depth; ++d) {
+                        n = n.child(rng() % n.child_count());
+                        sum += *n;
+                    }
+                }
+                return sum;
+            },
+            [&locked, &mutex](std::mt19937& rng) {
+                std::unique_lock lock(mutex);
+                auto parent = locked.root().child(rng() % FanOut).child(rng() % FanOut);
+                locked.erase_subtree(locked.emplace_node(parent, 0));
+                *locked.root().child(rng() % FanOut) = static_cast<int>(rng() % 100);
+            }
+        );
+    };
+}
+
+} // namespace tools::test
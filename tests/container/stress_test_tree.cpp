@@ -3,9 +3,16 @@
 
 #include <cpptools/container/tree.hpp>
 
+#include "tree_test_utilities.hpp"
+
 #include <cmath>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
 
 constexpr char TAGS[] = "[container][tree][stress]";
+constexpr char BENCHMARK_TAGS[] = "[container][tree][.benchmark]";
 
 namespace tools::test {
 
@@ -39,4 +46,160 @@ namespace tools::test {
     // }
 // }
 
-} // namespace tools::test
\ No newline at end of file
+namespace {
+
+tree<int> make_chain_tree(int length) {
+    tree<int> t;
+    auto node = t.emplace_node(t.root(), 0);
+    for (int i = 1; i < length; ++i) {
+        node = t.emplace_node(node, i);
+    }
+
+    return t;
+}
+
+tree<int> make_flat_tree(int width) {
+    tree<int> t;
+    auto root = t.emplace_node(t.root(), 0);
+    for (int i = 1; i < width; ++i) {
+        t.emplace_node(root, i);
+    }
+
+    return t;
+}
+
+/// @brief Tree whose leaves hang off a few wide nodes at the bottom of a
+/// long chain, so that extremum upkeep walks long paths and removals shift
+/// many siblings
+struct edit_workload {
+    static constexpr int ChainLength = 1'000;
+    static constexpr int InnerCount  = 64;
+    static constexpr int LeafCount   = 1'000;
+    static constexpr int EditCount   = 100'000;
+
+    tree<int> t;
+    std::vector<tree<int>::node_handle_t> inner;
+    std::vector<tree<int>::node_handle_t> leaves;
+
+    edit_workload() {
+        auto n = t.emplace_node(t.root(), 0);
+        for (int i = 1; i < ChainLength; ++i) {
+            n = t.emplace_node(n, i);
+        }
+
+        for (int i = 0; i < InnerCount; ++i) {
+            inner.push_back(t.emplace_node(n, i));
+            for (int j = 0; j < LeafCount; ++j) {
+                leaves.push_back(t.emplace_node(inner.back(), j));
+            }
+        }
+    }
+
+    /// @brief Emplace, erase and move random leaves, without inspecting the
+    /// tree so that edits can run within a batch
+    void run() {
+        std::mt19937 rng(0);
+        for (int i = 0; i < EditCount; ++i) {
+            auto destination = inner[rng() % inner.size()];
+            std::size_t picked = rng() % leaves.size();
+
+            switch (i % 3) {
+            case 0:
+                leaves.push_back(t.emplace_node(destination, i));
+                break;
+            case 1:
+                t.erase_subtree(leaves[picked]);
+                leaves[picked] = leaves.back();
+                leaves.pop_back();
+                break;
+            default:
+                t.move_subtree(destination, leaves[picked]);
+                break;
+            }
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE( "Tree copy throughput", BENCHMARK_TAGS ) {
+    const auto deep  = make_chain_tree(1'000'000);
+    const auto wide  = make_flat_tree(1'000'000);
+    const auto bushy = make_very_large_tree(9, 5);
+
+    BENCHMARK( "deep tree (1M nodes, depth 1M)" ) {
+        return tree<int>(deep);
+    };
+
+    BENCHMARK( "wide tree (1M nodes, fan-out 1M)" ) {
+        return tree<int>(wide);
+    };
+
+    BENCHMARK( "bushy tree (488k nodes, fan-out 5)" ) {
+        return tree<unsigned char>(bushy);
+    };
+}
+
+TEST_CASE( "Tree edit throughput, one by one and in a batch", BENCHMARK_TAGS ) {
+    BENCHMARK_ADVANCED( "100k edits, one by one" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<edit_workload> workloads(meter.runs());
+        meter.measure([&workloads](int run) {
+            workloads[run].run();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "100k edits, in a batch" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<edit_workload> workloads(meter.runs());
+        meter.measure([&workloads](int run) {
+            auto scope = workloads[run].t.batch();
+            workloads[run].run();
+        });
+    };
+}
+
+TEST_CASE( "Wide node child removal throughput", BENCHMARK_TAGS ) {
+    // removing every other child: one by one, each removal shifts all right
+    // siblings; in bulk, they are shifted once
+    auto every_other_one_by_one = [](tree<int>& t) {
+        auto root = t.root();
+        for (std::size_t i = 1; i < root.child_count(); ++i) {
+            t.erase_subtree(root.child(i));
+        }
+    };
+
+    auto every_other_in_bulk = [](tree<int>& t) {
+        return t.remove_children(t.root(), [](const auto& child) {
+            return *child % 2 == 0;
+        });
+    };
+
+    for (int width : { 10'000, 100'000 }) {
+        const auto wide = make_flat_tree(width + 1);
+        const auto label = std::to_string(width / 1000) + "k children";
+
+        if (width <= 10'000) {
+            BENCHMARK_ADVANCED( "one by one, " + label )(Catch::Benchmark::Chronometer meter) {
+                std::vector<tree<int>> trees(meter.runs(), wide);
+                meter.measure([&](int run) {
+                    every_other_one_by_one(trees[run]);
+                });
+            };
+        }
+
+        BENCHMARK_ADVANCED( "remove_children, " + label )(Catch::Benchmark::Chronometer meter) {
+            std::vector<tree<int>> trees(meter.runs(), wide);
+            meter.measure([&](int run) {
+                return every_other_in_bulk(trees[run]);
+            });
+        };
+
+        BENCHMARK_ADVANCED( "erase_children, " + label )(Catch::Benchmark::Chronometer meter) {
+            std::vector<tree<int>> trees(meter.runs(), wide);
+            meter.measure([&](int run) {
+                trees[run].erase_children(trees[run].root(), 0, width / 2);
+            });
+        };
+    }
+}
+
+} // namespace tools::test
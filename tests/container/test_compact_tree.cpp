@@ -0,0 +1,151 @@
+#include <ranges>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_range_equals.hpp>
+
+#include <cpptools/container/compact_tree.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
+
+using namespace Catch::Matchers;
+
+constexpr char TAGS[] = "[container][compact_tree]";
+
+namespace tools::test {
+
+namespace {
+
+compact_tree<int> make_sample_compact_tree() {
+    return {{
+        1, {    {2, {   {3},
+                        {4}}},
+                {5, {   {6},
+                        {7}}}}
+    }};
+}
+
+template<traversal::order O, typename Tree>
+std::vector<int> dfs_values(Tree& t) {
+    std::vector<int> result;
+    for (const int& value : dfs<O>(t)) {
+        result.push_back(value);
+    }
+
+    return result;
+}
+
+} // namespace
+
+TEST_CASE( "Default constructed compact tree is empty", TAGS ) {
+    compact_tree<int> t;
+
+    REQUIRE( t.empty() );
+    REQUIRE( t.size() == 0 );
+    REQUIRE( t.root() == compact_tree<int>::npos );
+    REQUIRE( dfs_values<traversal::pre_order>(t).empty() );
+}
+
+TEST_CASE( "Compact tree made from an initializer has correct structure", TAGS ) {
+    const auto t = make_sample_compact_tree();
+
+    REQUIRE( t.size() == 7 );
+
+    auto root = t.root();
+    auto n2   = t.first_child(root);
+    auto n5   = t.next_sibling(n2);
+
+    REQUIRE( t[root] == 1 );
+    REQUIRE( t[n2] == 2 );
+    REQUIRE( t[n5] == 5 );
+    REQUIRE( t.parent(n5) == root );
+    REQUIRE( t.next_sibling(n5) == compact_tree<int>::npos );
+    REQUIRE( t.child_count(root) == 2 );
+    REQUIRE( t.child_count(t.first_child(n5)) == 0 );
+}
+
+TEMPLATE_TEST_CASE( "Compact tree DFS traversal yields correctly ordered values", TAGS, compact_tree<int>, const compact_tree<int> ) {
+    TestType t = make_sample_compact_tree();
+
+    SECTION( "Pre-order" ) {
+        REQUIRE_THAT( dfs_values<traversal::pre_order>(t), RangeEquals(std::vector{ 1, 2, 3, 4, 5, 6, 7 }) );
+    }
+
+    SECTION( "Post-order" ) {
+        REQUIRE_THAT( dfs_values<traversal::post_order>(t), RangeEquals(std::vector{ 3, 4, 2, 6, 7, 5, 1 }) );
+    }
+}
+
+TEST_CASE( "Nodes can be emplaced in a compact tree", TAGS ) {
+    compact_tree<int> t;
+
+    auto root = t.emplace_node(compact_tree<int>::npos, 1);
+    auto n2   = t.emplace_node(root, 2);
+    auto n5   = t.emplace_node(root, 5);
+    t.emplace_node(n2, 3);
+    t.emplace_node(n2, 4);
+    t.emplace_node(n5, 6);
+    t.emplace_node(n5, 7);
+
+    REQUIRE( t == make_sample_compact_tree() );
+    REQUIRE_THAT( t, RangeEquals(std::vector{ 1, 2, 5, 3, 4, 6, 7 }) );
+}
+
+TEST_CASE( "Emplacing a root in a non-empty compact tree is rejected", TAGS ) {
+    auto t = make_sample_compact_tree();
+
+    REQUIRE_THROWS_AS( t.emplace_node(compact_tree<int>::npos, 8), exception::parameter::invalid_value_error );
+    REQUIRE( t == make_sample_compact_tree() );
+}
+
+TEST_CASE( "Children are appended after the last child left by an erasure", TAGS ) {
+    auto t = make_sample_compact_tree();
+    auto n2 = t.first_child(t.root());
+
+    t.erase_subtree(t.last_child(n2));
+    n2 = t.first_child(t.root());
+    t.emplace_node(n2, 8);
+
+    compact_tree<int> expected = {{ 1, {{ 2, {{3}, {8}}}, { 5, {{6}, {7}}}} }};
+
+    REQUIRE( t == expected );
+    REQUIRE( t[t.last_child(n2)] == 8 );
+}
+
+TEST_CASE( "Subtrees can be erased from a compact tree", TAGS ) {
+    auto t = make_sample_compact_tree();
+
+    SECTION( "Inner subtree" ) {
+        t.erase_subtree(t.first_child(t.root()));
+
+        compact_tree<int> expected = {{ 1, {{ 5, {{6}, {7}}}} }};
+
+        REQUIRE( t.size() == 4 );
+        REQUIRE( t == expected );
+        REQUIRE_THAT( t, RangeEquals(std::vector{ 1, 5, 6, 7 }) );
+    }
+
+    SECTION( "Middle leaf" ) {
+        auto n2 = t.first_child(t.root());
+        t.erase_subtree(t.next_sibling(t.first_child(n2)));
+
+        compact_tree<int> expected = {{ 1, {{ 2, {{3}}}, { 5, {{6}, {7}}}} }};
+
+        REQUIRE( t == expected );
+    }
+
+    SECTION( "Root" ) {
+        t.erase_subtree(t.root());
+
+        REQUIRE( t.empty() );
+    }
+}
+
+TEST_CASE( "Compact trees compare structure, not only values", TAGS ) {
+    compact_tree<int> flat  = {{ 1, {{2}, {3}} }};
+    compact_tree<int> chain = {{ 1, {{ 2, {{3}}}} }};
+
+    REQUIRE( flat != chain );
+    REQUIRE( flat == compact_tree<int>{{ 1, {{2}, {3}} }} );
+}
+
+} // namespace tools::test
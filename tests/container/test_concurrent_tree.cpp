@@ -0,0 +1,115 @@
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+//#include <cpptools/_internal/force_enable_debug.hpp>
+
+#include <cpptools/container/concurrent_tree.hpp>
+
+constexpr char TAGS[] = "[container][concurrent_tree]";
+
+namespace tools::test {
+
+TEST_CASE( "Concurrent tree readers see published versions", TAGS ) {
+    concurrent_tree<int> t(persistent_tree<int>({ 1, { { 2 }, { 3 } } }));
+    auto reader = t.make_reader();
+
+    {
+        auto version = reader.read();
+        CHECK(version->size() == 3);
+        CHECK(*version->root() == 1);
+    }
+
+    t.update([](persistent_tree<int>& staged) {
+        staged.emplace_node({ 0 }, 4);
+        staged.assign({}, 10);
+    });
+
+    auto version = reader.read();
+    CHECK(version->size() == 4);
+    CHECK(*version->root() == 10);
+    CHECK(*version->at({ 0, 0 }) == 4);
+}
+
+TEST_CASE( "Concurrent tree versions outlive publication while being read", TAGS ) {
+    concurrent_tree<int> t(persistent_tree<int>({ 1, { { 2 }, { 3 } } }));
+    auto reader = t.make_reader();
+
+    {
+        auto version = reader.read();
+
+        t.update([](persistent_tree<int>& staged) {
+            staged.erase_subtree({ 0 });
+        });
+
+        // the replaced version cannot be reclaimed while it is being read
+        t.reclaim();
+        CHECK(t.pending_reclamation() == 1);
+        CHECK(version->size() == 3);
+        CHECK(*version->at({ 0 }) == 2);
+    }
+
+    t.reclaim();
+    CHECK(t.pending_reclamation() == 0);
+
+    auto version = reader.read();
+    CHECK(version->size() == 2);
+}
+
+TEST_CASE( "Concurrent tree readers observe whole batches of mutations", TAGS ) {
+    constexpr int ReaderCount = 4;
+    constexpr int BatchCount  = 2000;
+
+    concurrent_tree<int> t;
+    t.update([](persistent_tree<int>& staged) {
+        staged.emplace_node({}, 0);
+    });
+
+    std::atomic<bool> done = false;
+    std::atomic<bool> torn = false;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < ReaderCount; ++i) {
+        readers.emplace_back([&t, &done, &torn]() {
+            auto reader = t.make_reader();
+            while (!done.load()) {
+                auto version = reader.read();
+
+                // every batch adds two children to the root and records
+                // the batch count in it
+                std::size_t count = 0;
+                for (auto it = version->begin(); it != version->end(); ++it) {
+                    ++count;
+                }
+
+                if (count != version->size()
+                 || version->root().child_count() != 2 * static_cast<std::size_t>(*version->root())) {
+                    torn = true;
+                }
+            }
+        });
+    }
+
+    for (int batch = 0; batch < BatchCount; ++batch) {
+        t.update([batch](persistent_tree<int>& staged) {
+            staged.emplace_node({}, batch);
+            staged.emplace_node({}, batch);
+            staged.assign({}, batch + 1);
+        });
+    }
+
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    CHECK(!torn);
+
+    t.reclaim();
+    CHECK(t.pending_reclamation() == 0);
+}
+
+} // namespace tools::test
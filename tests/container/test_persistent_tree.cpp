@@ -0,0 +1,156 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+//#include <cpptools/_internal/force_enable_debug.hpp>
+
+#include <cpptools/container/persistent_tree.hpp>
+
+constexpr char TAGS[] = "[container][persistent_tree]";
+
+namespace tools::test {
+
+namespace {
+
+persistent_tree<int>::initializer make_sample_persistent_tree_initializer() {
+    return {1, {
+        {2, {
+            {3},
+            {4}
+        }},
+        {5, {
+            {6},
+            {7}
+        }}
+    }};
+}
+
+template<typename Tree>
+std::vector<int> pre_order_values(const Tree& t) {
+    return std::vector<int>(t.begin(), t.end());
+}
+
+} // namespace
+
+TEST_CASE( "Default constructed persistent tree is empty", TAGS ) {
+    persistent_tree<int> t;
+
+    CHECK(t.empty());
+    CHECK(t.size() == 0);
+    CHECK(t.root().is_null());
+    CHECK(t.begin() == t.end());
+}
+
+TEST_CASE( "Persistent tree built from an initializer holds its values", TAGS ) {
+    persistent_tree<int> t(make_sample_persistent_tree_initializer());
+
+    CHECK(t.size() == 7);
+    CHECK(*t.root() == 1);
+    CHECK(t.root().child_count() == 2);
+    CHECK(*t.at({ 1, 0 }) == 6);
+    CHECK(t.at({ 0 }).descendant_count() == 2);
+    CHECK(pre_order_values(t) == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7 });
+}
+
+TEST_CASE( "Persistent tree mutations are not observed by snapshots", TAGS ) {
+    persistent_tree<int> t(make_sample_persistent_tree_initializer());
+    const auto snapshot = t.snapshot();
+
+    SECTION( "value assignment" ) {
+        t.assign({ 1, 0 }, 60);
+        t.modify({ 0 }, [](int& v) { v *= 10; });
+
+        CHECK(pre_order_values(t)        == std::vector<int>{ 1, 20, 3, 4, 5, 60, 7 });
+        CHECK(pre_order_values(snapshot) == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7 });
+    }
+
+    SECTION( "node emplacement" ) {
+        auto p = t.emplace_node({ 0 }, 8);
+        CHECK(p == persistent_tree<int>::path{ 0, 2 });
+
+        p = t.emplace_node_at({}, 1, 9);
+        CHECK(p == persistent_tree<int>::path{ 1 });
+
+        CHECK(t.size() == 9);
+        CHECK(t.at({ 0 }).descendant_count() == 3);
+        CHECK(pre_order_values(t) == std::vector<int>{ 1, 2, 3, 4, 8, 9, 5, 6, 7 });
+
+        CHECK(snapshot.size() == 7);
+        CHECK(pre_order_values(snapshot) == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7 });
+    }
+
+    SECTION( "subtree erasure" ) {
+        t.erase_subtree({ 0 });
+
+        CHECK(t.size() == 4);
+        CHECK(pre_order_values(t) == std::vector<int>{ 1, 5, 6, 7 });
+        CHECK(pre_order_values(snapshot) == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7 });
+
+        t.erase_subtree({});
+        CHECK(t.empty());
+        CHECK(snapshot.size() == 7);
+    }
+
+    CHECK(!(t == snapshot));
+}
+
+TEST_CASE( "Persistent tree versions share their unmodified nodes", TAGS ) {
+    persistent_tree<int> t(make_sample_persistent_tree_initializer());
+
+    SECTION( "copies share all nodes" ) {
+        const auto copy = t;
+
+        CHECK(copy.root() == t.root());
+        CHECK(copy == t);
+    }
+
+    SECTION( "mutations copy only the path to the mutated node" ) {
+        const auto snapshot = t.snapshot();
+        t.assign({ 1, 0 }, 60);
+
+        CHECK(t.root()     != snapshot.root());
+        CHECK(t.at({ 1 })  != snapshot.at({ 1 }));
+        CHECK(t.at({ 1, 0 }) != snapshot.at({ 1, 0 }));
+
+        CHECK(t.at({ 0 })    == snapshot.at({ 0 }));
+        CHECK(t.at({ 1, 1 }) == snapshot.at({ 1, 1 }));
+    }
+
+    SECTION( "nodes exclusive to a version are mutated in place" ) {
+        const auto before = t.at({ 1, 0 });
+        t.assign({ 1, 0 }, 60);
+
+        CHECK(t.at({ 1, 0 }) == before);
+        CHECK(*before == 60);
+    }
+}
+
+TEST_CASE( "Persistent tree versions sharing a deep tree can be dropped from different threads", TAGS ) {
+    persistent_tree<int> t;
+    persistent_tree<int>::path p = t.emplace_node({}, 0);
+    for (int i = 1; i < 2000; ++i) {
+        p = t.emplace_node(p, i);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        auto first  = std::make_unique<persistent_tree<int>>(t);
+        auto second = std::make_unique<persistent_tree<int>>(t);
+        t.clear();
+
+        std::thread other([&]{ first.reset(); });
+        second.reset();
+        other.join();
+
+        t = persistent_tree<int>(persistent_tree<int>::initializer{ 0 });
+        p = {};
+        for (int j = 1; j < 2000; ++j) {
+            p = t.emplace_node(p, j);
+        }
+    }
+
+    CHECK(t.size() == 2000);
+}
+
+} // namespace tools::test
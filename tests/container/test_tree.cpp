@@ -1,6 +1,13 @@
 #include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <sstream>
 #include <ranges>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_range_equals.hpp>
@@ -8,6 +15,9 @@
 //#include <cpptools/_internal/force_enable_debug.hpp>
 
 #include <cpptools/container/tree.hpp>
+#include <cpptools/exception/internal_exception.hpp>
+#include <cpptools/exception/io_exception.hpp>
+#include <cpptools/exception/parameter_exception.hpp>
 #include <cpptools/utility/merge_strategy.hpp>
 
 #include "tree_test_utilities.hpp"
@@ -43,6 +53,115 @@ TEST_CASE( "Tree copied from another has the same contents", TAGS ) {
     }
 }
 
+TEST_CASE( "Copy assignment reuses the nodes of the assigned tree", TAGS ) {
+    const auto original = make_sample_tree();
+
+    tree<int> target = {{
+        10, {   {20, {  {30},
+                        {40}}},
+                {50, {  {60},
+                        {70}}}}
+    }};
+    auto target_elements = get_elements_and_addresses(target.root());
+
+    SECTION( "same shape" ) {
+        target = original;
+
+        REQUIRE( target == original );
+        REQUIRE( &target.root().value()                   == target_elements.at(10) );
+        REQUIRE( &target.root().child(1).child(1).value() == target_elements.at(70) );
+    }
+
+    SECTION( "assigned tree has fewer nodes" ) {
+        const tree<int> smaller = {{ 1, {{ 2, {{3}}}} }};
+        target = smaller;
+
+        REQUIRE( target == smaller );
+        REQUIRE( target.size() == 3 );
+        REQUIRE( *target.rightmost() == 3 );
+        REQUIRE( &target.root().child(0).child(0).value() == target_elements.at(30) );
+    }
+
+    SECTION( "assigned tree has more nodes" ) {
+        const tree<int> larger = {{
+            1, {    {2, {   {3, {{8}, {9}}},
+                            {4}}},
+                    {5, {   {6},
+                            {7}}},
+                    {11}}
+        }};
+        target = larger;
+
+        REQUIRE( target == larger );
+        REQUIRE( target.size() == 10 );
+        REQUIRE( *target.leftmost() == 8 );
+        REQUIRE( *target.rightmost() == 11 );
+        REQUIRE( &target.root().child(1).value() == target_elements.at(50) );
+    }
+}
+
+namespace {
+
+/// @brief Allocator counting its allocations, propagated on copy assignment
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+
+    std::size_t* allocations = nullptr;
+
+    counting_allocator() noexcept = default;
+
+    explicit counting_allocator(std::size_t* allocations) noexcept : allocations(allocations) {}
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>& other) noexcept : allocations(other.allocations) {}
+
+    T* allocate(std::size_t n) {
+        if (allocations) {
+            ++*allocations;
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>& other) const noexcept {
+        return allocations == other.allocations;
+    }
+};
+
+} // namespace
+
+TEST_CASE( "Copy assignment propagating the allocator allocates from the new one", TAGS ) {
+    using alloc_t = counting_allocator<int>;
+    using tree_t  = detail::unsafe_tree<int, alloc_t>;
+
+    std::size_t lhs_allocations = 0;
+    std::size_t rhs_allocations = 0;
+
+    tree_t lhs(alloc_t{ &lhs_allocations });
+    lhs.emplace_node(lhs.emplace_node(nullptr, 1), 2);
+
+    tree_t rhs(alloc_t{ &rhs_allocations });
+    auto rhs_root = rhs.emplace_node(nullptr, 3);
+    rhs.emplace_node(rhs_root, 4);
+    rhs.emplace_node(rhs_root, 5);
+
+    const std::size_t lhs_before = lhs_allocations;
+    const std::size_t rhs_before = rhs_allocations;
+    lhs = rhs;
+    lhs.emplace_node(lhs.root(), 6);
+
+    REQUIRE( lhs.get_allocator() == rhs.get_allocator() );
+    REQUIRE( lhs_allocations == lhs_before );
+    REQUIRE( rhs_allocations > rhs_before );
+    REQUIRE( lhs.size() == 4 );
+}
+
 TEST_CASE( "Tree copied from a subtree has the same contents", TAGS ) {
     const auto original = make_sample_tree();
     const auto n5 = original.root().child(1);
@@ -60,6 +179,19 @@ TEST_CASE( "Tree copied from a subtree has the same contents", TAGS ) {
     }
 }
 
+TEST_CASE( "Copying a degenerate tree does not recurse once per node", TAGS ) {
+    tree<int> chain;
+    auto node = chain.emplace_node(chain.root(), 0);
+    for (int i = 1; i < 200'000; ++i) {
+        node = chain.emplace_node(node, i);
+    }
+
+    tree<int> copy(chain);
+
+    REQUIRE( copy.size() == chain.size() );
+    REQUIRE( copy == chain );
+}
+
 TEST_CASE( "Tree steals content from another during move", TAGS ) {
     auto original = make_sample_tree();
     auto original_elements = get_elements_and_addresses(original.root());
@@ -386,6 +518,69 @@ TEST_CASE( "Elements can be erased from a tree", TAGS ) {
     }
 }
 
+TEST_CASE( "Children of a node can be erased in bulk", TAGS ) {
+    tree<int> t;
+    auto root = t.emplace_node(t.root(), 0);
+    for (int i = 1; i <= 10; ++i) {
+        auto child = t.emplace_node(root, i);
+        t.emplace_node(child, 10 * i);
+    }
+    t.enable_subtree_sizes();
+    REQUIRE( t.size() == 21 );
+
+    SECTION( "by predicate" ) {
+        auto removed = t.remove_children(root, [](const auto& child) {
+            return *child % 2 == 1 || *child == 10;
+        });
+
+        REQUIRE( removed == 6 );
+        REQUIRE( t.size() == 9 );
+        REQUIRE( root.descendant_count() == 8 );
+        REQUIRE( *t.leftmost() == 20 );
+        REQUIRE( *t.rightmost() == 80 );
+
+        for (std::size_t i = 0; i < root.child_count(); ++i) {
+            REQUIRE( *root.child(i) == 2 * (static_cast<int>(i) + 1) );
+            REQUIRE( root.child(i).sibling_index() == i );
+        }
+    }
+
+    SECTION( "by range" ) {
+        t.erase_children(root, 3, 7);
+
+        tree<int> result = {{
+            0, {    {1, {{10}}}, {2, {{20}}}, {3, {{30}}},
+                    {8, {{80}}}, {9, {{90}}}, {10, {{100}}}}
+        }};
+
+        REQUIRE( t == result );
+        REQUIRE( root.descendant_count() == 12 );
+        REQUIRE( root.child(3).sibling_index() == 3 );
+        REQUIRE( root.child(3).left_sibling().value() == 3 );
+
+        t.erase_children(root, 0, 6);
+        REQUIRE( t.size() == 1 );
+        REQUIRE( t.leftmost() == root );
+        REQUIRE( t.rightmost() == root );
+    }
+
+    SECTION( "a throwing predicate leaves the tree consistent" ) {
+        int calls = 0;
+        REQUIRE_THROWS( t.remove_children(root, [&calls](const auto&) {
+            if (++calls == 4) {
+                throw 0;
+            }
+            return true;
+        }) );
+
+        REQUIRE( t.size() == 15 );
+        REQUIRE( root.child_count() == 7 );
+        REQUIRE( *root.child(0) == 4 );
+        REQUIRE( root.child(0).sibling_index() == 0 );
+        REQUIRE( *t.leftmost() == 40 );
+    }
+}
+
 TEST_CASE( "Erasing the root of a tree makes it an empty tree", TAGS ) {
     auto t = make_sample_tree();
 
@@ -476,6 +671,62 @@ TEST_CASE( "A node can be emplaced in the tree as child of another node", TAGS )
     REQUIRE( t.size() == 8 );
 }
 
+TEST_CASE( "Nodes keep track of their children past their inline capacity", TAGS ) {
+    tree<int> t;
+    auto root = t.emplace_node(t.root(), 0);
+
+    std::vector<tree<int>::node_handle_t> children;
+    for (int i = 1; i <= 8; ++i) {
+        children.push_back(t.emplace_node(root, i));
+    }
+
+    REQUIRE( root.child_count() == 8 );
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        REQUIRE( root.child(i) == children[i] );
+        REQUIRE( *root.child(i) == static_cast<int>(i) + 1 );
+    }
+
+    SECTION( "erasing children keeps the remaining ones in order" ) {
+        t.erase_subtree(children[0]);
+        t.erase_subtree(children[4]);
+        t.erase_subtree(children[7]);
+
+        tree<int> result = {{
+            0, {    {2}, {3}, {4}, {6}, {7}}
+        }};
+
+        REQUIRE( t == result );
+        REQUIRE( root.child(3).left_sibling() == children[3] );
+        REQUIRE( root.child(3).right_sibling() == children[6] );
+    }
+
+    SECTION( "merging a wide node into a narrow one spills its children" ) {
+        auto n1 = children[0];
+        for (int i = 10; i < 15; ++i) {
+            t.emplace_node(n1, i);
+        }
+
+        t.merge_with_parent<merge::keep>(n1);
+
+        tree<int> result = {{
+            0, {    {10}, {11}, {12}, {13}, {14},
+                    {2}, {3}, {4}, {5}, {6}, {7}, {8}}
+        }};
+
+        REQUIRE( t == result );
+        REQUIRE( root.child_count() == 12 );
+        REQUIRE( root.child(5) == children[1] );
+        REQUIRE( root.child(5).left_sibling().value() == 14 );
+    }
+
+    SECTION( "child storage cannot grow past its counts" ) {
+        detail::child_storage<int*, 4> storage;
+
+        REQUIRE_THROWS_AS( storage.reserve(std::size_t{1} << 32), exception::parameter::invalid_value_error );
+        REQUIRE( storage.capacity() == 4 );
+    }
+}
+
 TEST_CASE( "Subtrees can be chopped off", TAGS ) {
     auto t = make_sample_tree();
 
@@ -496,6 +747,87 @@ TEST_CASE( "Subtrees can be chopped off", TAGS ) {
     REQUIRE( t == remainder );
 }
 
+TEST_CASE( "Chopped subtrees share node storage with their original tree", TAGS ) {
+    auto t = make_sample_tree();
+    auto n2 = t.root().child(0);
+    auto n3_address = &n2.child(0).value();
+
+    auto chopped = t.chop_subtree(n2);
+
+    REQUIRE( t.size() == 4 );
+    REQUIRE( chopped.size() == 3 );
+    REQUIRE( std::ranges::distance(t) == 4 );
+    REQUIRE( std::ranges::distance(chopped) == 3 );
+
+    SECTION( "chopped subtree outlives the original tree" ) {
+        t.clear();
+
+        REQUIRE( &chopped.root().child(0).value() == n3_address );
+        REQUIRE( chopped == tree<int>{{ 2, {{3}, {4}}}} );
+    }
+
+    SECTION( "chopped subtree can be adopted back" ) {
+        t.adopt_subtree(t.root(), std::move(chopped));
+
+        REQUIRE( t.size() == 7 );
+        REQUIRE( std::ranges::distance(t) == 7 );
+        REQUIRE( chopped.empty() );
+        REQUIRE( &t.root().child(1).child(0).value() == n3_address );
+    }
+}
+
+TEST_CASE( "Trees sharing node storage can be mutated from different threads", TAGS ) {
+    auto t = make_sample_tree();
+    auto chopped = t.chop_subtree(t.root().child(0));
+
+    constexpr int count = 10000;
+    auto grow_and_shrink = [](tree<int>& target) {
+        auto where = target.root();
+        for (int i = 0; i < count; ++i) {
+            auto n = target.emplace_node(where, i);
+            if (i % 3 == 0) {
+                target.erase_subtree(n);
+            }
+        }
+    };
+
+    {
+        std::jthread other(grow_and_shrink, std::ref(chopped));
+        grow_and_shrink(t);
+    }
+
+    constexpr std::size_t kept = count - (count + 2) / 3;
+    REQUIRE( t.size() == 4 + kept );
+    REQUIRE( chopped.size() == 3 + kept );
+    REQUIRE( std::ranges::distance(t) == static_cast<std::ptrdiff_t>(t.size()) );
+    REQUIRE( std::ranges::distance(chopped) == static_cast<std::ptrdiff_t>(chopped.size()) );
+    REQUIRE( t.root().child(1).value() == 1 );
+    REQUIRE( chopped.root().child(2).value() == 1 );
+
+    SECTION( "until one of them is handed over to the other" ) {
+        t.adopt_subtree(t.root(), std::move(chopped));
+
+        // the storage is used by a single tree again, and iterated as such
+        REQUIRE( t.size() == 7 + 2 * kept );
+        REQUIRE( std::ranges::distance(t) == static_cast<std::ptrdiff_t>(t.size()) );
+
+        {
+            std::jthread other(grow_and_shrink, std::ref(t));
+        }
+        REQUIRE( std::ranges::distance(t) == static_cast<std::ptrdiff_t>(t.size()) );
+    }
+
+    SECTION( "until one of them is destroyed" ) {
+        {
+            std::jthread other([&chopped]{ auto dropped = std::move(chopped); });
+            grow_and_shrink(t);
+        }
+
+        REQUIRE( t.size() == 4 + 2 * kept );
+        REQUIRE( std::ranges::distance(t) == static_cast<std::ptrdiff_t>(t.size()) );
+    }
+}
+
 TEST_CASE( "Subtrees can be moved within a tree", TAGS ) {
     auto t = make_sample_tree();
 
@@ -598,6 +930,119 @@ TEST_CASE( "Node can be merged with its parent", TAGS ) {
     }
 }
 
+TEST_CASE( "Mutations in a batch yield the same tree as applied one by one", TAGS ) {
+    auto batched = make_sample_tree();
+    auto eager   = make_sample_tree();
+
+    const bool sized = GENERATE(false, true);
+    if (sized) {
+        batched.enable_subtree_sizes();
+        eager.enable_subtree_sizes();
+    }
+
+    // apply the same edits to both trees, addressing nodes by their path
+    // from the root in the eager tree
+    auto edit = [&](auto&& f) {
+        f(eager);
+        f(batched);
+    };
+
+    {
+        auto scope = batched.batch();
+        REQUIRE( batched.in_batch() );
+
+        auto n3 = batched.root().child(0).child(0);
+        auto n4 = batched.root().child(0).child(1);
+        auto n5 = batched.root().child(1);
+        auto n6 = n5.child(0);
+        auto n7 = n5.child(1);
+
+        auto e3 = eager.root().child(0).child(0);
+        auto e4 = eager.root().child(0).child(1);
+        auto e5 = eager.root().child(1);
+        auto e6 = e5.child(0);
+        auto e7 = e5.child(1);
+
+        // leftmost node loses its first child, then gets moved under a
+        // right sibling which is erased afterwards along with it
+        auto n8 = batched.emplace_node(n3, 8);
+        auto n9 = batched.emplace_node(n3, 9);
+        auto e8 = eager.emplace_node(e3, 8);
+        auto e9 = eager.emplace_node(e3, 9);
+        batched.erase_subtree(n8);
+        eager.erase_subtree(e8);
+
+        batched.move_subtree(n7, n9);
+        eager.move_subtree(e7, e9);
+        batched.move_subtree(n4, n6);
+        eager.move_subtree(e4, e6);
+        batched.erase_subtree(n3);
+        eager.erase_subtree(e3);
+
+        // nested batches only take effect once the outermost one commits
+        {
+            auto nested = batched.batch();
+            batched.emplace_node(n4, 10);
+            eager.emplace_node(e4, 10);
+            batched.erase_subtree(n7);
+            eager.erase_subtree(e7);
+        }
+        REQUIRE( batched.in_batch() );
+
+        batched.emplace_node(n5, 11);
+        eager.emplace_node(e5, 11);
+    }
+
+    REQUIRE( !batched.in_batch() );
+    REQUIRE( batched == eager );
+    REQUIRE( batched.size() == eager.size() );
+    REQUIRE( *batched.leftmost() == *eager.leftmost() );
+    REQUIRE( *batched.rightmost() == *eager.rightmost() );
+
+    tree<int> result = {{
+        1, {    {2, {   {4, {   {6},
+                                {10}}}}},
+                {5, {   {11}}}}
+    }};
+    REQUIRE( batched == result );
+
+    // parent metadata was fixed up
+    auto n4 = batched.root().child(0).child(0);
+    REQUIRE( n4.child(1).sibling_index() == 1 );
+    REQUIRE( n4.child(1).left_sibling() == n4.child(0) );
+    REQUIRE( batched.root().child(1).sibling_index() == 1 );
+    REQUIRE( batched.root().descendant_count() == 6 );
+
+    // the tree keeps being maintained after the batch
+    edit([](tree<int>& t) { t.erase_subtree(t.rightmost()); });
+    REQUIRE( batched == eager );
+    REQUIRE( batched.rightmost() == batched.root().child(1) );
+}
+
+TEST_CASE( "A batch can be committed before the end of its scope", TAGS ) {
+    auto t = make_sample_tree();
+    auto scope = t.batch();
+
+    auto n3 = t.root().child(0).child(0);
+    t.erase_subtree(n3);
+    scope.commit();
+
+    REQUIRE( !t.in_batch() );
+    REQUIRE( *t.leftmost() == 4 );
+    REQUIRE( t.root().child(0).child_count() == 1 );
+    REQUIRE( t.root().child(0).child(0).sibling_index() == 0 );
+
+    SECTION( "and the tree swapped once it is" ) {
+        auto other = make_sample_tree();
+        swap(t, other);
+
+        REQUIRE( !t.in_batch() );
+        REQUIRE( !other.in_batch() );
+        REQUIRE( t == make_sample_tree() );
+        REQUIRE( other.root().child(0).child_count() == 1 );
+    }
+}
+
 TEMPLATE_TEST_CASE( "DFS traversal yields correctly ordered values", TAGS, tree<int>, const tree<int> ) {
     TestType t = make_sample_tree();
 
@@ -621,4 +1066,529 @@ TEMPLATE_TEST_CASE( "DFS traversal yields correctly ordered values", TAGS, tree<
     }
 }
 
+TEMPLATE_TEST_CASE( "BFS traversal yields values level by level", TAGS, tree<int>, const tree<int> ) {
+    TestType t = make_sample_tree();
+
+    std::vector<int> values;
+    for (const int& value : bfs(t)) {
+        values.push_back(value);
+    }
+
+    REQUIRE_THAT( values, RangeEquals(std::array{ 1, 2, 5, 3, 4, 6, 7 }) );
+}
+
+TEMPLATE_TEST_CASE( "Level traversal yields each depth as a span of nodes", TAGS, tree<int>, const tree<int> ) {
+    TestType t = make_sample_tree();
+
+    std::vector<std::vector<int>> depths;
+    for (const auto& level : levels(t)) {
+        depths.emplace_back();
+        for (const auto& node : level) {
+            depths.back().push_back(*node);
+        }
+    }
+
+    REQUIRE( depths.size() == 3 );
+    REQUIRE_THAT( depths[0], RangeEquals(std::array{ 1 }) );
+    REQUIRE_THAT( depths[1], RangeEquals(std::array{ 2, 5 }) );
+    REQUIRE_THAT( depths[2], RangeEquals(std::array{ 3, 4, 6, 7 }) );
+}
+
+TEST_CASE( "Parallel reduction over a tree matches a sequential traversal", TAGS ) {
+    const auto t = make_very_large_tree(8, 5);
+
+    std::size_t expected_sum = 0;
+    for (unsigned char value : dfs<traversal::pre_order>(t)) {
+        expected_sum += value;
+    }
+
+    SECTION( "commutative combine" ) {
+        auto sum = parallel_reduce(t, [](unsigned char v) { return std::size_t{v}; }, std::plus<>{});
+
+        REQUIRE( sum == expected_sum );
+    }
+
+    SECTION( "non-commutative combine is applied in pre-order" ) {
+        using span_t = std::pair<unsigned char, unsigned char>;
+        auto ends = parallel_reduce(t,
+            [](unsigned char v) { return span_t{ v, v }; },
+            [](span_t lhs, span_t rhs) { return span_t{ lhs.first, rhs.second }; }
+        );
+
+        REQUIRE( ends.first  == *t.root() );
+        REQUIRE( ends.second == *t.rightmost() );
+    }
+
+    SECTION( "result type without a default value" ) {
+        struct total {
+            explicit total(std::size_t value) : value(value) {}
+            std::size_t value;
+        };
+
+        auto sum = parallel_reduce(t,
+            [](unsigned char v) { return total(v); },
+            [](total lhs, total rhs) { return total(lhs.value + rhs.value); }
+        );
+
+        REQUIRE( sum.value == expected_sum );
+        REQUIRE_THROWS_AS(
+            parallel_reduce(tree<unsigned char>(), [](unsigned char v) { return total(v); }, [](total lhs, total) { return lhs; }),
+            exception::internal::precondition_failure_error
+        );
+    }
+}
+
+TEST_CASE( "Parallel for_each visits every value of a tree once", TAGS ) {
+    auto t = make_very_large_tree(8, 5);
+
+    parallel_for_each(t, [](unsigned char& v) { v = 1; });
+    auto count = parallel_reduce(t, [](unsigned char v) { return std::size_t{v}; }, std::plus<>{});
+
+    REQUIRE( count == t.size() );
+}
+
+TEST_CASE( "Ancestor index answers ancestry queries like a walk up the tree", TAGS ) {
+    auto t = make_sample_tree();
+    t.enable_ancestor_index();
+    REQUIRE( t.has_ancestor_index() );
+
+    auto root = t.root();
+    auto n2 = root.child(0);
+    auto n5 = root.child(1);
+
+    auto check_all_pairs = [&]() {
+        std::vector<tree<int>::node_handle_t> nodes;
+        for (const auto& level : levels(t)) {
+            nodes.insert(nodes.end(), level.begin(), level.end());
+        }
+
+        for (const auto& n : nodes) {
+            for (const auto& ancestor : nodes) {
+                REQUIRE( t.has_parent(n, ancestor) == n.has_parent(ancestor) );
+                REQUIRE( t.is_parent_of(ancestor, n) == ancestor.is_parent_of(n) );
+            }
+        }
+    };
+
+    check_all_pairs();
+
+    SECTION( "after emplacing nodes" ) {
+        auto n8 = t.emplace_node(n2.child(1), 8);
+        t.emplace_node(n8, 9);
+
+        REQUIRE_FALSE( t.ancestor_index_up_to_date() );
+        check_all_pairs();
+        t.reindex();
+        REQUIRE( t.ancestor_index_up_to_date() );
+        check_all_pairs();
+    }
+
+    SECTION( "after erasing a subtree" ) {
+        t.erase_subtree(n5.child(0));
+
+        check_all_pairs();
+    }
+
+    SECTION( "after moving a subtree" ) {
+        t.move_subtree(n2.child(0), n5);
+
+        check_all_pairs();
+        t.reindex();
+        check_all_pairs();
+        REQUIRE( t.rightmost() == n2.child(1) );
+    }
+
+    SECTION( "after emplacing and moving nodes in a batch" ) {
+        {
+            auto scope = t.batch();
+            auto n8 = t.emplace_node(n2.child(1), 8);
+            t.emplace_node(n8, 9);
+            t.move_subtree(n2.child(0), n5);
+        }
+
+        REQUIRE( t.ancestor_index_up_to_date() );
+        check_all_pairs();
+        REQUIRE( t.rightmost() == n2.child(1).child(0).child(0) );
+    }
+
+    SECTION( "after disabling the index" ) {
+        t.disable_ancestor_index();
+        REQUIRE_FALSE( t.has_ancestor_index() );
+
+        check_all_pairs();
+    }
+}
+
+TEST_CASE( "Removing the leftmost branch of a tree moves the leftmost node to the next branch", TAGS ) {
+    auto t = make_sample_tree();
+    t.enable_ancestor_index();
+
+    auto n5 = t.root().child(1);
+    REQUIRE( t.has_parent(n5, t.root()) );
+
+    SECTION( "Erasing" ) {
+        t.erase_subtree(t.root().child(0));
+
+        REQUIRE( t.leftmost() == n5.child(0) );
+        REQUIRE( t.rightmost() == n5.child(1) );
+    }
+
+    SECTION( "Chopping" ) {
+        auto chopped = t.chop_subtree(t.root().child(0));
+
+        REQUIRE( t.leftmost() == n5.child(0) );
+        REQUIRE( *chopped.leftmost() == 3 );
+        REQUIRE( *chopped.rightmost() == 4 );
+    }
+}
+
+TEST_CASE( "LCA index finds common ancestors, distances and paths", TAGS ) {
+    auto t = make_sample_tree();
+    t.emplace_node(t.root().child(0).child(1), 8);
+
+    tree<int>::lca_index index(t);
+
+    auto root = t.root();
+    auto n2 = root.child(0);
+    auto n3 = n2.child(0);
+    auto n4 = n2.child(1);
+    auto n5 = root.child(1);
+    auto n7 = n5.child(1);
+    auto n8 = n4.child(0);
+
+    REQUIRE( index.lca(n3, n8) == n2 );
+    REQUIRE( index.lca(n8, n3) == n2 );
+    REQUIRE( index.lca(n8, n7) == root );
+    REQUIRE( index.lca(n4, n8) == n4 );
+    REQUIRE( index.lca(n5, n5) == n5 );
+
+    REQUIRE( index.depth(n8) == 3 );
+    REQUIRE( index.distance(n8, n7) == 5 );
+    REQUIRE( index.distance(n2, n2) == 0 );
+
+    std::vector<int> path_values;
+    for (const auto& n : index.path(n8, n7)) {
+        path_values.push_back(*n);
+    }
+    REQUIRE_THAT( path_values, RangeEquals(std::vector{ 8, 4, 2, 1, 5, 7 }) );
+
+    SECTION( "Bulk queries" ) {
+        std::vector<std::pair<tree<int>::const_node_handle_t, tree<int>::const_node_handle_t>> queries = {
+            { n3, n4 }, { n8, n7 }, { n4, n8 }
+        };
+
+        auto result = index.lca(queries);
+
+        REQUIRE( result.size() == 3 );
+        REQUIRE( result[0] == n2 );
+        REQUIRE( result[1] == root );
+        REQUIRE( result[2] == n4 );
+    }
+
+    SECTION( "Index goes stale once the tree is mutated" ) {
+        REQUIRE_FALSE( index.stale() );
+
+        t.erase_subtree(n8);
+
+        REQUIRE( index.stale() );
+    }
+}
+
+TEST_CASE( "LCA index agrees with walking up the tree", TAGS ) {
+    const auto t = make_very_large_tree(4, 4);
+    tree<unsigned char>::lca_index index(t);
+
+    std::vector<tree<unsigned char>::const_node_handle_t> nodes;
+    for (const auto& level : levels(t)) {
+        nodes.insert(nodes.end(), level.begin(), level.end());
+    }
+
+    auto naive_lca = [](auto lhs, auto rhs) {
+        while (lhs != rhs && !rhs.has_parent(lhs)) {
+            lhs = lhs.parent();
+        }
+
+        return lhs;
+    };
+
+    for (std::size_t i = 0; i < nodes.size(); i += 7) {
+        for (std::size_t j = 0; j < nodes.size(); j += 5) {
+            REQUIRE( index.lca(nodes[i], nodes[j]) == naive_lca(nodes[i], nodes[j]) );
+        }
+    }
+}
+
+TEST_CASE( "Cached subtree sizes follow the structure of the tree", TAGS ) {
+    auto t = make_sample_tree();
+    t.enable_subtree_sizes();
+    REQUIRE( t.has_subtree_sizes() );
+
+    auto root = t.root();
+    auto n2 = root.child(0);
+    auto n5 = root.child(1);
+
+    auto check_sizes_and_ranks = [&]() {
+        std::vector<int> ranked_values;
+        for (std::size_t rank = 0; rank < t.size(); ++rank) {
+            auto n = t.nth_pre_order(rank);
+            ranked_values.push_back(*n);
+
+            std::size_t descendants = 0;
+            for (const auto& child : n.children()) {
+                descendants += 1 + child.descendant_count();
+            }
+
+            REQUIRE( t.descendant_count(n) == descendants );
+            REQUIRE( t.pre_order_index(n) == rank );
+        }
+
+        REQUIRE_THAT( ranked_values, RangeEquals(dfs<traversal::pre_order>(t)) );
+    };
+
+    REQUIRE( t.descendant_count(root) == 6 );
+    REQUIRE( *t.nth_pre_order(4) == 5 );
+    check_sizes_and_ranks();
+
+    SECTION( "after emplacing nodes" ) {
+        auto n8 = t.emplace_node(n2.child(1), 8);
+        t.emplace_node(n8, 9);
+
+        REQUIRE( t.descendant_count(root) == 8 );
+        check_sizes_and_ranks();
+    }
+
+    SECTION( "after erasing a subtree" ) {
+        t.erase_subtree(n2);
+
+        REQUIRE( t.descendant_count(root) == 3 );
+        check_sizes_and_ranks();
+    }
+
+    SECTION( "after moving a subtree" ) {
+        t.move_subtree(n2.child(0), n5);
+
+        REQUIRE( t.descendant_count(n2) == 5 );
+        check_sizes_and_ranks();
+    }
+
+    SECTION( "after merging a node with its parent" ) {
+        t.merge_with_parent(n5);
+
+        REQUIRE( t.descendant_count(root) == 5 );
+        check_sizes_and_ranks();
+    }
+
+    SECTION( "after chopping and adopting a subtree" ) {
+        auto chopped = t.chop_subtree(n5);
+        REQUIRE( chopped.has_subtree_sizes() );
+        REQUIRE( t.descendant_count(root) == 3 );
+        check_sizes_and_ranks();
+
+        t.adopt_subtree(n2.child(0), make_sample_tree());
+        REQUIRE( t.descendant_count(root) == 10 );
+        check_sizes_and_ranks();
+    }
+
+    SECTION( "after copy-assigning another tree" ) {
+        auto other = make_sample_tree();
+        other.emplace_node(other.root().child(1).child(0), 8);
+        t = other;
+
+        REQUIRE( t.descendant_count(t.root()) == 7 );
+        check_sizes_and_ranks();
+    }
+
+    SECTION( "after disabling subtree sizes" ) {
+        t.disable_subtree_sizes();
+        REQUIRE_FALSE( t.has_subtree_sizes() );
+
+        t.emplace_node(n5, 8);
+        REQUIRE( t.descendant_count(root) == 7 );
+    }
+}
+
+TEST_CASE( "Subtree hashes tell trees apart and locate their differences", TAGS ) {
+    auto t = make_sample_tree();
+    auto other = make_sample_tree();
+    t.enable_hashing();
+    other.enable_hashing();
+    REQUIRE( t.has_hashing() );
+
+    REQUIRE( t.subtree_hash(t.root()) == other.subtree_hash(other.root()) );
+    REQUIRE( t == other );
+    REQUIRE( t.differing_subtrees(other).empty() );
+
+    SECTION( "after modifying a value in place" ) {
+        auto n6 = t.root().child(1).child(0);
+        *n6 = 8;
+        t.touch(n6);
+
+        REQUIRE( t.subtree_hash(t.root()) != other.subtree_hash(other.root()) );
+        REQUIRE( t.subtree_hash(t.root().child(0)) == other.subtree_hash(other.root().child(0)) );
+        REQUIRE( t != other );
+
+        auto differences = t.differing_subtrees(other);
+        REQUIRE( differences.size() == 1 );
+        REQUIRE( differences[0].first == n6 );
+        REQUIRE( *differences[0].second == 6 );
+    }
+
+    SECTION( "after changing the structure of the tree" ) {
+        t.emplace_node(t.root().child(0).child(0), 8);
+        t.erase_subtree(t.root().child(1).child(1));
+
+        REQUIRE( t.subtree_hash(t.root()) != other.subtree_hash(other.root()) );
+
+        auto differences = t.differing_subtrees(other);
+        REQUIRE( differences.size() == 2 );
+        REQUIRE( *differences[0].first == 3 );
+        REQUIRE( *differences[1].first == 5 );
+
+        t.erase_subtree(t.root().child(0).child(0).child(0));
+        t.emplace_node(t.root().child(1), 7);
+
+        REQUIRE( t.subtree_hash(t.root()) == other.subtree_hash(other.root()) );
+        REQUIRE( t == other );
+    }
+
+    SECTION( "after moving subtrees around" ) {
+        auto n5 = t.root().child(1);
+        t.move_subtree(t.root().child(0).child(1), n5);
+
+        REQUIRE( t != other );
+
+        t.move_subtree(t.root(), n5);
+
+        REQUIRE( t == other );
+        REQUIRE( t.subtree_hash(t.root()) == other.subtree_hash(other.root()) );
+    }
+
+    SECTION( "after rehashing" ) {
+        t.emplace_node(t.root().child(0), 8);
+        const auto stale = t.subtree_hash(t.root());
+        t.rehash();
+
+        REQUIRE( t.subtree_hash(t.root()) == stale );
+    }
+
+    SECTION( "after modifying a value in place without reporting it" ) {
+        *t.root().child(1).child(0) = 8;
+
+        REQUIRE( t != other );
+    }
+}
+
+namespace {
+
+struct unhashable {
+    int value;
+    bool operator==(const unhashable&) const = default;
+};
+
+template<typename Tree>
+constexpr bool can_enable_hashing = requires (Tree& t) { t.enable_hashing(); };
+
+} // namespace
+
+TEST_CASE( "Trees of values without a hash can be compared", TAGS ) {
+    tree<unhashable> t;
+    tree<unhashable> other;
+    t.emplace_node(t.root(), 1);
+    other.emplace_node(other.root(), 2);
+
+    STATIC_REQUIRE( can_enable_hashing<tree<int>> );
+    STATIC_REQUIRE_FALSE( can_enable_hashing<tree<unhashable>> );
+    REQUIRE( t != other );
+
+    *other.root() = { 1 };
+    REQUIRE( t == other );
+}
+
+TEST_CASE( "Trees can be built in bulk from flat arrays", TAGS ) {
+    const auto expected = make_sample_tree();
+    constexpr auto NoParent = tree<int>::no_parent;
+
+    SECTION( "parent array" ) {
+        const std::vector<int>         values  = { 2, 1, 6, 3, 5, 7, 4 };
+        const std::vector<std::size_t> parents = { 1, NoParent, 4, 0, 1, 4, 0 };
+
+        auto t = tree<int>::from_parent_array(values, parents);
+
+        REQUIRE( t == expected );
+        REQUIRE( *t.leftmost() == 3 );
+        REQUIRE( *t.rightmost() == 7 );
+    }
+
+    SECTION( "pre-order values and child counts" ) {
+        const std::vector<int>         values       = { 1, 2, 3, 4, 5, 6, 7 };
+        const std::vector<std::size_t> child_counts = { 2, 2, 0, 0, 2, 0, 0 };
+
+        auto t = tree<int>::from_preorder(values, child_counts);
+
+        REQUIRE( t == expected );
+        REQUIRE( *t.leftmost() == 3 );
+        REQUIRE( *t.rightmost() == 7 );
+    }
+
+    SECTION( "malformed arrays are rejected" ) {
+        const std::vector<int> values = { 1, 2, 3 };
+
+        REQUIRE_THROWS_AS( tree<int>::from_parent_array(values, std::vector<std::size_t>{ NoParent, 0, NoParent }), exception::parameter::invalid_value_error );
+        REQUIRE_THROWS_AS( tree<int>::from_parent_array(values, std::vector<std::size_t>{ NoParent, 2, 1 }),        exception::parameter::invalid_value_error );
+        REQUIRE_THROWS_AS( tree<int>::from_preorder(values, std::vector<std::size_t>{ 1, 0, 0 }),                   exception::parameter::invalid_value_error );
+        REQUIRE_THROWS_AS( tree<int>::from_preorder(values, std::vector<std::size_t>{ 3, 0, 0 }),                   exception::parameter::invalid_value_error );
+        REQUIRE_THROWS_AS( tree<int>::from_preorder(values, std::vector<std::size_t>{ std::size_t{1} << 32, 0, 0 }), exception::parameter::invalid_value_error );
+        REQUIRE_THROWS_AS( tree<int>::from_preorder(values, std::vector<std::size_t>{ 1, ~std::size_t{0}, 0 }),       exception::parameter::invalid_value_error );
+    }
+}
+
+TEST_CASE( "Trees written in flat format can be viewed without deserialization", TAGS ) {
+    auto t = make_sample_tree();
+    t.emplace_node(t.root().child(0).child(1), 8);
+
+    auto check_view = [&](const flat_tree_view<int>& view) {
+        REQUIRE( view.size() == t.size() );
+        REQUIRE_THAT( dfs<traversal::pre_order>(view), RangeEquals(dfs<traversal::pre_order>(t)) );
+
+        REQUIRE( view.descendant_count(0) == 7 );
+        REQUIRE( view.descendant_count(1) == 3 );
+        REQUIRE( view.first_child(3) == 4 );
+        REQUIRE( view.first_child(2) == flat_tree_view<int>::npos );
+
+        std::vector<int> root_children;
+        for (auto n = view.first_child(0); n != view.subtree_end(0); n = view.subtree_end(n)) {
+            root_children.push_back(view.value(n));
+        }
+        REQUIRE_THAT( root_children, RangeEquals(std::vector{ 2, 5 }) );
+    };
+
+    SECTION( "in memory" ) {
+        std::ostringstream os(std::ios::binary);
+        write_flat(t, os);
+        const std::string bytes = os.str();
+
+        check_view(flat_tree_view<int>(std::as_bytes(std::span(bytes))));
+    }
+
+    SECTION( "in a mapped file" ) {
+        const auto path = std::filesystem::temp_directory_path() / "cpptools_test_flat_tree.bin";
+        save_flat(t, path);
+
+        {
+            auto view = flat_tree_view<int>::open(path);
+            check_view(view);
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    SECTION( "of another type is rejected" ) {
+        std::ostringstream os(std::ios::binary);
+        write_flat(t, os);
+        const std::string bytes = os.str();
+
+        REQUIRE_THROWS_AS( flat_tree_view<double>(std::as_bytes(std::span(bytes))), exception::io::invalid_input_stream_error );
+    }
+}
+
 } // namespace tools::container
\ No newline at end of file
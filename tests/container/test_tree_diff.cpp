@@ -0,0 +1,169 @@
+#include <cstddef>
+#include <random>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+//#include <cpptools/_internal/force_enable_debug.hpp>
+
+#include <cpptools/container/tree.hpp>
+#include <cpptools/container/tree_diff.hpp>
+
+#include "tree_test_utilities.hpp"
+
+constexpr char TAGS[] = "[container][tree][diff]";
+
+namespace tools::test {
+
+namespace {
+
+std::vector<tree<int>::node_handle_t> all_nodes(tree<int>& t) {
+    std::vector<tree<int>::node_handle_t> nodes;
+    for (const auto& level : levels(t)) {
+        nodes.insert(nodes.end(), level.begin(), level.end());
+    }
+
+    return nodes;
+}
+
+} // namespace
+
+TEST_CASE( "Diff of equal trees is empty", TAGS ) {
+    auto a = make_sample_tree();
+    auto b = make_sample_tree();
+
+    CHECK(diff(a, b).empty());
+    CHECK(diff(tree<int>{}, tree<int>{}).empty());
+
+    a.enable_hashing();
+    b.enable_hashing();
+    CHECK(diff(a, b).empty());
+
+    *b.root() = 99;
+    *a.root() = 99;
+    CHECK(diff(a, b).empty());
+}
+
+TEST_CASE( "Patching a tree with its diff to another makes them equal", TAGS ) {
+    auto a = make_sample_tree();
+    auto b = make_sample_tree();
+
+    const bool hashed = GENERATE(false, true);
+    if (hashed) {
+        a.enable_hashing();
+        b.enable_hashing();
+    }
+
+    SECTION( "value change" ) {
+        auto n = b.root().child(1).child(0);
+        *n = 99;
+        if (hashed) {
+            b.touch(n);
+            b.rehash();
+            REQUIRE(b.hashes_up_to_date());
+        }
+
+        auto script = diff(a, b);
+        REQUIRE(script.size() == 1);
+        CHECK(std::holds_alternative<edit::assign<int>>(script.front()));
+        CHECK(std::get<edit::assign<int>>(script.front()).path == std::vector<std::size_t>{ 1, 0 });
+
+        patch(a, script);
+        CHECK(a == b);
+    }
+
+    SECTION( "subtree insertion" ) {
+        b.adopt_subtree(b.root().child(1), 0, make_sample_tree());
+
+        auto script = diff(a, b);
+        REQUIRE(script.size() == 1);
+        CHECK(std::holds_alternative<edit::insert<int>>(script.front()));
+        CHECK(std::get<edit::insert<int>>(script.front()).position == 0);
+
+        patch(a, script);
+        CHECK(a == b);
+    }
+
+    SECTION( "subtree removal" ) {
+        b.erase_subtree(b.root().child(0));
+
+        auto script = diff(a, b);
+        REQUIRE(script.size() == 1);
+        CHECK(std::holds_alternative<edit::erase>(script.front()));
+
+        patch(a, script);
+        CHECK(a == b);
+    }
+
+    SECTION( "value change which was not reported" ) {
+        *b.root().child(1).child(0) = 99;
+
+        auto script = diff(a, b);
+        REQUIRE(script.size() == 1);
+        CHECK(std::holds_alternative<edit::assign<int>>(script.front()));
+
+        patch(a, script);
+        CHECK(a == b);
+    }
+
+    SECTION( "from and to an empty tree" ) {
+        tree<int> empty;
+
+        patch(a, diff(a, empty));
+        CHECK(a.empty());
+
+        patch(a, diff(a, b));
+        CHECK(a == b);
+    }
+}
+
+TEST_CASE( "Diff and patch round trip on randomly edited trees", TAGS ) {
+    std::mt19937 rng(42);
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        tree<int> a;
+        a.emplace_node(a.root(), 0);
+        for (int i = 1; i < 60; ++i) {
+            auto nodes = all_nodes(a);
+            a.emplace_node(nodes[rng() % nodes.size()], static_cast<int>(rng() % 10));
+        }
+
+        tree<int> b = a;
+        const bool hashed = (iteration % 2) != 0;
+        if (hashed) {
+            a.enable_hashing();
+            b.enable_hashing();
+        }
+
+        const int edit_count = 1 + static_cast<int>(rng() % 5);
+        for (int e = 0; e < edit_count; ++e) {
+            auto nodes = all_nodes(b);
+            auto n = nodes[rng() % nodes.size()];
+
+            switch (rng() % 3) {
+            case 0:
+                *n = 100 + e;
+                if (hashed) {
+                    b.touch(n);
+                }
+                break;
+            case 1:
+                if (n != b.root()) {
+                    b.erase_subtree(n);
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                b.adopt_subtree(n, rng() % (n.child_count() + 1), make_sample_tree());
+                break;
+            }
+        }
+
+        patch(a, diff(a, b));
+        REQUIRE(a == b);
+    }
+}
+
+} // namespace tools::test
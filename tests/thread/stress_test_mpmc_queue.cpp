@@ -0,0 +1,126 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/mpmc_queue.hpp>
+#include <cpptools/thread/queue_worker.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr char BENCHMARK_TAGS[] = "[thread][mpmc_queue][.benchmark]";
+
+namespace tools::test {
+
+namespace {
+
+constexpr std::size_t item_count = 1'000'000;
+
+/// @brief Push a share of the items from several threads at once
+template<typename F>
+void produce(std::size_t producer_count, F&& push_share) {
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < producer_count; ++p) {
+        producers.emplace_back([&push_share, p, producer_count]{
+            push_share(p, item_count / producer_count);
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+}
+
+}
+
+TEST_CASE("MPMC queue throughput into a queue worker", BENCHMARK_TAGS) {
+    const std::size_t producer_count = GENERATE(1, 2, 4);
+    const std::size_t batch_size = GENERATE(1, 64);
+
+    mpmc_queue<std::uint64_t> queue(1024);
+    std::atomic<std::size_t> consumed = 0;
+    std::uint64_t sum = 0;
+
+    queue_worker<std::uint64_t> consumer(queue, [&](std::span<std::uint64_t> batch) {
+        for (auto value : batch) {
+            sum += value;
+        }
+        consumed.fetch_add(batch.size(), std::memory_order_release);
+    }, batch_size);
+
+    BENCHMARK(
+        "1M items, " + std::to_string(producer_count) + " producer(s), batches of " + std::to_string(batch_size)
+    ) {
+        consumed.store(0);
+        produce(producer_count, [&queue](std::size_t p, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                queue.push(p + i);
+            }
+        });
+
+        const std::size_t expected = item_count / producer_count * producer_count;
+        while (consumed.load(std::memory_order_acquire) != expected) {
+            std::this_thread::yield();
+        }
+
+        return sum;
+    };
+}
+
+TEST_CASE("MPMC queue tail latency into a queue worker", BENCHMARK_TAGS) {
+    using clock = std::chrono::steady_clock;
+
+    const std::size_t producer_count = GENERATE(1, 2);
+    const bool paced = GENERATE(false, true);
+
+    mpmc_queue<clock::rep> queue(1024);
+    std::vector<clock::rep> latencies;
+    latencies.reserve(item_count);
+    std::atomic<std::size_t> consumed = 0;
+
+    {
+        queue_worker<clock::rep> consumer(queue, [&](std::span<clock::rep> batch) {
+            const auto now = clock::now().time_since_epoch().count();
+            for (auto pushed_at : batch) {
+                latencies.push_back(now - pushed_at);
+            }
+            consumed.fetch_add(batch.size(), std::memory_order_release);
+        });
+
+        produce(producer_count, [&queue, paced](std::size_t, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                queue.push(clock::now().time_since_epoch().count());
+                if (paced) {
+                    // Leave the consumer time to catch up, so that latency is
+                    // not dominated by the backlog of a full queue
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        while (consumed.load(std::memory_order_acquire) != item_count / producer_count * producer_count) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        const auto index = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+        return std::chrono::duration<double, std::micro>(clock::duration(latencies[index])).count();
+    };
+
+    Catch::cout()
+        << producer_count << " producer(s), " << (paced ? "paced" : "saturated") << ", latency in us:"
+        << " p50 " << percentile(0.5)
+        << " p99 " << percentile(0.99)
+        << " p99.9 " << percentile(0.999)
+        << " max " << percentile(1.0) << '\n';
+}
+
+} // namespace tools::test
@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/periodic_worker.hpp>
+
+#include <chrono>
+#include <thread>
+
+constexpr char BENCHMARK_TAGS[] = "[thread][periodic_worker][.benchmark]";
+
+namespace tools::test {
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Periodic worker jitter at 1 kHz", BENCHMARK_TAGS) {
+    const auto spin_threshold = GENERATE(0us, 50us, 200us);
+
+    periodic_worker w(1ms, []{}, true, periodic_worker::overrun_policy::skip, spin_threshold);
+    std::this_thread::sleep_for(2s);
+    w.wait_until_finalized();
+
+    const auto stats = w.stats();
+    const auto us = [](periodic_worker::clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+
+    Catch::cout()
+        << "spin threshold " << us(spin_threshold) << " us: "
+        << stats.iterations << " runs, "
+        << stats.overruns << " overruns, "
+        << stats.skipped << " skipped, lateness in us:"
+        << " min " << us(stats.min_lateness)
+        << " mean " << us(stats.mean_lateness)
+        << " stddev " << us(stats.lateness_stddev)
+        << " max " << us(stats.max_lateness) << '\n';
+}
+
+} // namespace tools::test
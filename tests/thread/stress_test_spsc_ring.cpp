@@ -0,0 +1,143 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/queue_worker.hpp>
+#include <cpptools/thread/spsc_ring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr char BENCHMARK_TAGS[] = "[thread][spsc_ring][.benchmark]";
+
+namespace tools::test {
+
+namespace {
+
+constexpr std::size_t item_count = 10'000'000;
+constexpr std::size_t ring_capacity = 4096;
+
+/// @brief Run a consumer in a thread of its own while producing from the
+/// calling thread
+template<typename Producer, typename Consumer>
+std::uint64_t run_pipeline(Producer&& produce, Consumer&& consume) {
+    std::uint64_t sum = 0;
+    std::thread consumer([&]{ sum = consume(); });
+    produce();
+    consumer.join();
+
+    return sum;
+}
+
+}
+
+// Items per second are item_count divided by the measured time. To look at
+// cache behaviour, run these under a profiler counting cache misses, e.g.:
+//   perf stat -e cache-references,cache-misses cpptools_tests "[spsc_ring][.benchmark]"
+// The producer and consumer indices live on separate cache lines, and each
+// side only reads the index of the other side when its cached copy says the
+// ring is full or empty, so misses stay well below one per item.
+TEST_CASE("SPSC ring throughput between two threads", BENCHMARK_TAGS) {
+    spsc_ring<std::uint64_t> ring(ring_capacity);
+
+    BENCHMARK("10M items, one at a time") {
+        return run_pipeline(
+            [&ring]{
+                for (std::size_t i = 0; i < item_count; ++i) {
+                    ring.push(i);
+                }
+            },
+            [&ring]{
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < item_count; ++i) {
+                    sum += ring.pop();
+                }
+                return sum;
+            }
+        );
+    };
+
+    const std::size_t batch_size = GENERATE(16, 256);
+
+    BENCHMARK("10M items, push_n/pop_n in batches of " + std::to_string(batch_size)) {
+        return run_pipeline(
+            [&ring, batch_size]{
+                std::vector<std::uint64_t> batch(batch_size);
+                for (std::size_t next = 0; next < item_count;) {
+                    const std::size_t count = std::min(batch_size, item_count - next);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        batch[i] = next + i;
+                    }
+
+                    std::size_t pushed = 0;
+                    while (pushed < count) {
+                        const std::size_t just_pushed = ring.push_n(batch.begin() + static_cast<std::ptrdiff_t>(pushed), count - pushed);
+                        if (just_pushed == 0) {
+                            std::this_thread::yield();
+                        }
+                        pushed += just_pushed;
+                    }
+                    next += count;
+                }
+            },
+            [&ring, batch_size]{
+                std::uint64_t sum = 0;
+                std::vector<std::uint64_t> batch;
+                batch.reserve(batch_size);
+                for (std::size_t popped = 0; popped < item_count;) {
+                    batch.clear();
+                    const std::size_t count = ring.pop_n(std::back_inserter(batch), batch_size);
+                    if (count == 0) {
+                        ring.wait_for_items([]{ return false; });
+                        continue;
+                    }
+
+                    for (auto value : batch) {
+                        sum += value;
+                    }
+                    popped += count;
+                }
+                return sum;
+            }
+        );
+    };
+
+    BENCHMARK("10M items, reserve/commit into a queue worker, batches of " + std::to_string(batch_size)) {
+        std::atomic<std::size_t> consumed = 0;
+        std::uint64_t sum = 0;
+
+        queue_worker<std::uint64_t, spsc_ring<std::uint64_t>> consumer(ring, [&](std::span<std::uint64_t> batch) {
+            for (auto value : batch) {
+                sum += value;
+            }
+            consumed.fetch_add(batch.size(), std::memory_order_release);
+        }, batch_size);
+
+        for (std::size_t next = 0; next < item_count;) {
+            auto slots = ring.reserve(std::min(batch_size, item_count - next));
+            if (slots.empty()) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (auto& slot : slots) {
+                slot = next++;
+            }
+            ring.commit(slots.size());
+        }
+
+        while (consumed.load(std::memory_order_acquire) != item_count) {
+            std::this_thread::yield();
+        }
+
+        return sum;
+    };
+}
+
+} // namespace tools::test
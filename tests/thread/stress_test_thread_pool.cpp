@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/thread_pool.hpp>
+#include <cpptools/thread/worker.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr char BENCHMARK_TAGS[] = "[thread][thread_pool][.benchmark]";
+
+namespace tools::test {
+
+namespace {
+
+constexpr std::size_t task_count = 10000;
+
+/// @brief Small CPU-bound job standing for the body of a task
+std::uint64_t pool_job(std::size_t seed, std::size_t rounds) {
+    std::uint64_t x = seed + 1;
+    for (std::size_t i = 0; i < rounds; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+
+    return x;
+}
+
+/// @brief Jobs drained one at a time by a single worker
+struct worker_jobs {
+    std::mutex mutex;
+    std::deque<std::size_t> jobs;
+    std::size_t rounds = 0;
+    std::vector<std::uint64_t> results;
+    std::atomic<std::size_t> done = 0;
+
+    void drain() {
+        std::size_t job;
+        {
+            std::scoped_lock lock(mutex);
+            if (jobs.empty()) {
+                return;
+            }
+
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        results[job] = pool_job(job, rounds);
+        done.fetch_add(1, std::memory_order_release);
+    }
+};
+
+}
+
+TEST_CASE("Thread pool throughput against a single worker", BENCHMARK_TAGS) {
+    const std::size_t rounds = GENERATE(100, 10000);
+    worker_jobs worker_state;
+    worker_state.rounds = rounds;
+    worker_state.results.assign(task_count, 0);
+
+    worker single([&worker_state]{ worker_state.drain(); });
+
+    BENCHMARK("Single worker, " + std::to_string(rounds) + " rounds per task") {
+        worker_state.done.store(0);
+        {
+            std::scoped_lock lock(worker_state.mutex);
+            for (std::size_t i = 0; i < task_count; ++i) {
+                worker_state.jobs.push_back(i);
+            }
+        }
+
+        while (worker_state.done.load(std::memory_order_acquire) != task_count) {
+            std::this_thread::yield();
+        }
+
+        return worker_state.results.back();
+    };
+
+    single.wait_until_finalized();
+
+    thread_pool pool;
+    std::vector<std::uint64_t> results(task_count);
+
+    BENCHMARK("Thread pool submit, " + std::to_string(rounds) + " rounds per task") {
+        std::vector<std::future<std::uint64_t>> futures;
+        futures.reserve(task_count);
+        for (std::size_t i = 0; i < task_count; ++i) {
+            futures.push_back(pool.submit([i, rounds]{ return pool_job(i, rounds); }));
+        }
+
+        for (std::size_t i = 0; i < task_count; ++i) {
+            results[i] = futures[i].get();
+        }
+
+        return results.back();
+    };
+
+    BENCHMARK("Thread pool parallel_for, " + std::to_string(rounds) + " rounds per task") {
+        pool.parallel_for(0, task_count, [&results, rounds](std::size_t i) {
+            results[i] = pool_job(i, rounds);
+        });
+
+        return results.back();
+    };
+}
+
+} // namespace tools::test
@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/worker.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+constexpr char BENCHMARK_TAGS[] = "[thread][worker][.benchmark]";
+
+namespace tools::test {
+
+namespace {
+
+constexpr std::size_t iteration_count = 1'000'000;
+
+std::atomic<std::size_t> iterations = 0;
+worker* benchmarked_worker = nullptr;
+
+/// @brief Near-empty task, so that the loop of the worker dominates
+void count_iteration() {
+    if (iterations.fetch_add(1, std::memory_order_relaxed) + 1 == iteration_count) {
+        benchmarked_worker->pause();
+    }
+}
+
+}
+
+TEST_CASE("Worker per-iteration overhead", BENCHMARK_TAGS) {
+    worker w(count_iteration, false);
+    benchmarked_worker = &w;
+    w.wait_until_paused(false);
+
+    BENCHMARK("1M iterations of a near-empty task") {
+        iterations.store(0, std::memory_order_relaxed);
+        w.run();
+
+        // The worker pauses itself after its last iteration
+        while (iterations.load(std::memory_order_relaxed) < iteration_count) {
+            std::this_thread::yield();
+        }
+        w.wait_until_paused(false);
+
+        return iterations.load(std::memory_order_relaxed);
+    };
+
+    w.wait_until_finalized();
+}
+
+} // namespace tools::test
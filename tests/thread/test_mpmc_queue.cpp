@@ -0,0 +1,193 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/thread/mpmc_queue.hpp>
+#include <cpptools/thread/queue_worker.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+constexpr char TAGS[] = "[thread][mpmc_queue]";
+
+namespace tools::test {
+
+TEST_CASE("An MPMC queue is a bounded FIFO", TAGS) {
+    mpmc_queue<int> queue(5);
+    REQUIRE(queue.capacity() == 8);
+    REQUIRE(queue.empty());
+    REQUIRE_FALSE(queue.try_pop());
+
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(queue.try_push(i));
+    }
+    REQUIRE_FALSE(queue.try_push(8));
+    REQUIRE(queue.size_approx() == 8);
+
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 8; ++i) {
+            auto value = queue.try_pop();
+            REQUIRE(value);
+            REQUIRE(*value == lap * 8 + i);
+            REQUIRE(queue.try_push((lap + 1) * 8 + i));
+        }
+    }
+
+    std::vector<int> drained;
+    REQUIRE(queue.try_pop_n(std::back_inserter(drained), 5) == 5);
+    REQUIRE(queue.try_pop_n(std::back_inserter(drained), 5) == 3);
+    REQUIRE(drained == std::vector<int>{ 24, 25, 26, 27, 28, 29, 30, 31 });
+    REQUIRE(queue.empty());
+
+    SECTION("A queue cannot have no capacity") {
+        REQUIRE_THROWS_AS(mpmc_queue<int>(0), exception::parameter::invalid_value_error);
+    }
+}
+
+TEST_CASE("An MPMC queue holds move-only items and destroys leftovers", TAGS) {
+    auto tracker = std::make_shared<int>(0);
+
+    {
+        mpmc_queue<std::shared_ptr<int>> queue(4);
+        queue.push(tracker);
+        queue.push(tracker);
+        REQUIRE(tracker.use_count() == 3);
+
+        auto value = queue.pop();
+        REQUIRE(value == tracker);
+    }
+
+    REQUIRE(tracker.use_count() == 1);
+
+    mpmc_queue<std::unique_ptr<int>> queue(2);
+    auto item = std::make_unique<int>(7);
+    REQUIRE(queue.try_push(std::move(item)));
+    REQUIRE_FALSE(item);
+    REQUIRE(*queue.pop() == 7);
+}
+
+TEST_CASE("Items go through an MPMC queue exactly once under contention", TAGS) {
+    constexpr std::size_t producer_count = 3;
+    constexpr std::size_t consumer_count = 3;
+    constexpr std::size_t items_per_producer = 20000;
+
+    // Small capacity and no spinning, so that both sides park often
+    mpmc_queue<std::size_t> queue(16, 0);
+    std::vector<std::atomic<int>> seen(producer_count * items_per_producer);
+
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producer_count; ++p) {
+        threads.emplace_back([&queue, p]{
+            for (std::size_t i = 0; i < items_per_producer; ++i) {
+                queue.push(p * items_per_producer + i);
+            }
+        });
+    }
+    for (std::size_t c = 0; c < consumer_count; ++c) {
+        threads.emplace_back([&queue, &seen]{
+            for (std::size_t i = 0; i < producer_count * items_per_producer / consumer_count; ++i) {
+                seen[queue.pop()].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& count : seen) {
+        REQUIRE(count.load() == 1);
+    }
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("A queue worker drains its queue in batches", TAGS) {
+    constexpr std::size_t item_count = 10000;
+    constexpr std::size_t batch_size = 32;
+
+    mpmc_queue<std::size_t> queue(128);
+    std::vector<std::size_t> received;
+    std::atomic<std::size_t> received_count = 0;
+    std::size_t largest_batch = 0;
+
+    queue_worker<std::size_t> consumer(queue, [&](std::span<std::size_t> batch) {
+        largest_batch = std::max(largest_batch, batch.size());
+        received.insert(received.end(), batch.begin(), batch.end());
+        received_count.fetch_add(batch.size(), std::memory_order_release);
+    }, batch_size);
+
+    // Pushing blocks whenever the worker lags behind by the queue capacity
+    for (std::size_t i = 0; i < item_count; ++i) {
+        queue.push(i);
+    }
+
+    while (received_count.load(std::memory_order_acquire) != item_count) {
+        std::this_thread::yield();
+    }
+
+    consumer.wait_until_finalized();
+    REQUIRE(largest_batch <= batch_size);
+
+    std::vector<std::size_t> expected(item_count);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(received == expected);
+}
+
+TEST_CASE("A queue worker waiting for items can be paused and finalized", TAGS) {
+    mpmc_queue<int> queue(8);
+    std::atomic<int> sum = 0;
+
+    queue_worker<int> consumer(queue, [&sum](std::span<int> batch) {
+        for (int value : batch) {
+            sum.fetch_add(value);
+        }
+    });
+
+    consumer.wait_until_running(false);
+    // Let the worker run out of items and park
+    std::this_thread::yield();
+
+    consumer.wait_until_paused();
+    REQUIRE(consumer.paused());
+
+    // Items pushed while paused wait for the worker to resume
+    queue.push(1);
+    queue.push(2);
+    REQUIRE(sum.load() == 0);
+
+    consumer.wait_until_running();
+    while (sum.load() != 3) {
+        std::this_thread::yield();
+    }
+
+    consumer.wait_until_finalized();
+    REQUIRE(consumer.finalized());
+}
+
+TEST_CASE("A queue worker which never started can be destroyed", TAGS) {
+    mpmc_queue<int> queue(8);
+    queue.push(1);
+
+    {
+        queue_worker<int> consumer(queue, [](std::span<int>) {}, 16, false);
+        consumer.wait_until_paused(false);
+    }
+
+    REQUIRE(queue.size_approx() == 1);
+}
+
+TEST_CASE("A queue worker cannot hand out empty batches", TAGS) {
+    mpmc_queue<int> queue(8);
+
+    REQUIRE_THROWS_AS(
+        queue_worker<int>(queue, [](std::span<int>) {}, 0),
+        exception::parameter::invalid_value_error
+    );
+}
+
+} // namespace tools::test
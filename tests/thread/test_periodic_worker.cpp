@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/thread/periodic_worker.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+constexpr char TAGS[] = "[thread][periodic_worker]";
+
+namespace tools::test {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+void wait_for_calls(const std::atomic<std::size_t>& calls, std::size_t count) {
+    while (calls.load() < count) {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+}
+
+TEST_CASE("A periodic worker runs its task at a fixed rate", TAGS) {
+    std::atomic<std::size_t> calls = 0;
+    const auto spin_threshold = GENERATE(0us, 200us);
+
+    const auto start = periodic_worker::clock::now();
+    periodic_worker w(5ms, [&calls]{ calls.fetch_add(1); }, true, periodic_worker::overrun_policy::skip, spin_threshold);
+    REQUIRE(w.period() == 5ms);
+
+    wait_for_calls(calls, 10);
+    const auto elapsed = periodic_worker::clock::now() - start;
+    w.wait_until_finalized();
+
+    // The first run is immediate, the nine other ones wait for their deadline
+    REQUIRE(elapsed >= 45ms);
+
+    const auto stats = w.stats();
+    REQUIRE(stats.iterations == calls.load());
+    REQUIRE(stats.min_lateness >= 0ms);
+    REQUIRE(stats.min_lateness <= stats.mean_lateness);
+    REQUIRE(stats.mean_lateness <= stats.max_lateness);
+    // Whether runs were skipped depends on how busy the machine is
+    REQUIRE(stats.overruns <= stats.skipped);
+
+    w.reset_stats();
+    REQUIRE(w.stats().iterations == 0);
+}
+
+TEST_CASE("A periodic worker cannot have a period which is not positive", TAGS) {
+    std::atomic<std::size_t> calls = 0;
+    const auto period = GENERATE(0ms, -5ms);
+
+    REQUIRE_THROWS_AS(periodic_worker(period, [&calls]{ calls.fetch_add(1); }), exception::parameter::invalid_value_error);
+    REQUIRE(calls.load() == 0);
+}
+
+TEST_CASE("A periodic worker handles overruns according to its policy", TAGS) {
+    std::atomic<std::size_t> calls = 0;
+
+    // The first run lasts four periods, the other ones are short
+    const auto task = [&calls]{
+        if (calls.fetch_add(1) == 0) {
+            std::this_thread::sleep_for(20ms);
+        }
+    };
+
+    SECTION("Catching up") {
+        periodic_worker w(5ms, task, true, periodic_worker::overrun_policy::catch_up);
+        wait_for_calls(calls, 6);
+        w.wait_until_finalized();
+
+        const auto stats = w.stats();
+        REQUIRE(stats.overruns >= 1);
+        REQUIRE(stats.skipped == 0);
+        // Late runs start right away, the furthest behind one at least three
+        // periods late
+        REQUIRE(stats.max_lateness >= 10ms);
+    }
+
+    SECTION("Skipping") {
+        periodic_worker w(5ms, task, true, periodic_worker::overrun_policy::skip);
+        wait_for_calls(calls, 3);
+        w.wait_until_finalized();
+
+        const auto stats = w.stats();
+        REQUIRE(stats.overruns >= 1);
+        REQUIRE(stats.skipped >= 3);
+    }
+}
+
+TEST_CASE("A periodic worker can be paused and finalized between runs", TAGS) {
+    std::atomic<std::size_t> calls = 0;
+
+    // Long enough a period that waiting it out would fail the test
+    periodic_worker w(1h, [&calls]{ calls.fetch_add(1); }, false);
+    w.wait_until_paused(false);
+    REQUIRE(calls.load() == 0);
+
+    const auto start = periodic_worker::clock::now();
+
+    // Resuming runs the task right away, then sleeps for a period
+    w.wait_until_running();
+    wait_for_calls(calls, 1);
+
+    w.wait_until_paused();
+    REQUIRE(w.paused());
+
+    w.wait_until_running();
+    wait_for_calls(calls, 2);
+
+    w.wait_until_finalized();
+    REQUIRE(w.finalized());
+    REQUIRE(periodic_worker::clock::now() - start < 1min);
+    REQUIRE(calls.load() == 2);
+}
+
+} // namespace tools::test
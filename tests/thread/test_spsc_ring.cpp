@@ -0,0 +1,202 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/exception/parameter_exception.hpp>
+#include <cpptools/thread/queue_worker.hpp>
+#include <cpptools/thread/spsc_ring.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+constexpr char TAGS[] = "[thread][spsc_ring]";
+
+namespace tools::test {
+
+TEST_CASE("An SPSC ring is a bounded FIFO", TAGS) {
+    spsc_ring<int> ring(6);
+    REQUIRE(ring.capacity() == 8);
+    REQUIRE(ring.empty());
+    REQUIRE_FALSE(ring.try_pop());
+
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(ring.try_push(i));
+    }
+    REQUIRE_FALSE(ring.try_push(8));
+    REQUIRE(ring.size_approx() == 8);
+
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 8; ++i) {
+            auto value = ring.try_pop();
+            REQUIRE(value);
+            REQUIRE(*value == lap * 8 + i);
+            REQUIRE(ring.try_push((lap + 1) * 8 + i));
+        }
+    }
+
+    std::vector<int> drained;
+    REQUIRE(ring.pop_n(std::back_inserter(drained), 5) == 5);
+    REQUIRE(ring.pop_n(std::back_inserter(drained), 5) == 3);
+    REQUIRE(drained == std::vector<int>{ 24, 25, 26, 27, 28, 29, 30, 31 });
+    REQUIRE(ring.empty());
+
+    SECTION("A ring cannot have no capacity") {
+        REQUIRE_THROWS_AS(spsc_ring<int>(0), exception::parameter::invalid_value_error);
+    }
+}
+
+TEST_CASE("SPSC ring slots can be written and read in place", TAGS) {
+    spsc_ring<int> ring(8);
+
+    // Move the positions so that the next batch wraps around
+    const std::vector<int> values = { 0, 1, 2, 3, 4 };
+    std::vector<int> popped;
+    REQUIRE(ring.push_n(values.begin(), values.size()) == 5);
+    REQUIRE(ring.pop_n(std::back_inserter(popped), 5) == 5);
+    REQUIRE(popped == values);
+
+    auto slots = ring.reserve(6);
+    REQUIRE(slots.size() == 3);
+    std::iota(slots.begin(), slots.end(), 10);
+    ring.commit(2);
+    REQUIRE(ring.size_approx() == 2);
+
+    slots = ring.reserve(6);
+    REQUIRE(slots.size() == 1);
+    slots[0] = 12;
+    ring.commit(1);
+
+    slots = ring.reserve(6);
+    REQUIRE(slots.size() == 5);
+    std::iota(slots.begin(), slots.end(), 13);
+    ring.commit(5);
+    REQUIRE(ring.reserve(1).empty());
+
+    auto items = ring.peek(8);
+    REQUIRE(std::vector<int>(items.begin(), items.end()) == std::vector<int>{ 10, 11, 12 });
+    ring.consume(1);
+
+    items = ring.peek(8);
+    REQUIRE(std::vector<int>(items.begin(), items.end()) == std::vector<int>{ 11, 12 });
+    ring.consume(2);
+
+    items = ring.peek(3);
+    REQUIRE(std::vector<int>(items.begin(), items.end()) == std::vector<int>{ 13, 14, 15 });
+    ring.consume(3);
+
+    REQUIRE(ring.size_approx() == 2);
+    REQUIRE(ring.push_n(values.begin(), values.size()) == 5);
+    REQUIRE(ring.push_n(values.begin(), values.size()) == 1);
+    REQUIRE_FALSE(ring.try_push(5));
+}
+
+TEST_CASE("SPSC ring items can be move-only", TAGS) {
+    spsc_ring<std::unique_ptr<int>> ring(2);
+
+    auto item = std::make_unique<int>(3);
+    REQUIRE(ring.try_push(std::move(item)));
+    REQUIRE_FALSE(item);
+
+    std::vector<std::unique_ptr<int>> batch;
+    batch.push_back(std::make_unique<int>(4));
+    REQUIRE(ring.push_n(std::make_move_iterator(batch.begin()), 1) == 1);
+
+    REQUIRE(*ring.pop() == 3);
+    REQUIRE(*ring.pop() == 4);
+}
+
+TEST_CASE("Items go through an SPSC ring in order across threads", TAGS) {
+    constexpr std::size_t item_count = 50000;
+    const std::size_t batch_size = GENERATE(1, 7, 64);
+
+    // Small capacity and no spinning, so that both sides park often
+    spsc_ring<std::size_t> ring(16, 0);
+
+    std::thread producer([&ring, batch_size]{
+        std::size_t next = 0;
+        while (next < item_count) {
+            if (batch_size == 1) {
+                ring.push(next++);
+                continue;
+            }
+
+            auto slots = ring.reserve(std::min(batch_size, item_count - next));
+            if (slots.empty()) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (auto& slot : slots) {
+                slot = next++;
+            }
+            ring.commit(slots.size());
+        }
+    });
+
+    std::size_t expected = 0;
+    bool in_order = true;
+    while (expected < item_count) {
+        if (batch_size == 1) {
+            in_order &= ring.pop() == expected++;
+            continue;
+        }
+
+        std::vector<std::size_t> batch;
+        if (ring.pop_n(std::back_inserter(batch), batch_size) == 0) {
+            ring.wait_for_items([]{ return false; });
+            continue;
+        }
+
+        for (auto value : batch) {
+            in_order &= value == expected++;
+        }
+    }
+
+    producer.join();
+    REQUIRE(in_order);
+    REQUIRE(ring.empty());
+}
+
+TEST_CASE("A queue worker reads batches from an SPSC ring in place", TAGS) {
+    constexpr std::size_t item_count = 10000;
+
+    spsc_ring<std::size_t> ring(64);
+    std::vector<std::size_t> received;
+    std::atomic<std::size_t> received_count = 0;
+    const std::size_t* ring_begin = nullptr;
+    bool in_place = true;
+
+    {
+        // Find out where the slots of the ring lie
+        auto slots = ring.reserve(1);
+        ring_begin = slots.data();
+    }
+
+    queue_worker<std::size_t, spsc_ring<std::size_t>> consumer(ring, [&](std::span<std::size_t> batch) {
+        in_place &= batch.data() >= ring_begin && batch.data() + batch.size() <= ring_begin + ring.capacity();
+        received.insert(received.end(), batch.begin(), batch.end());
+        received_count.fetch_add(batch.size(), std::memory_order_release);
+    }, 16);
+
+    for (std::size_t i = 0; i < item_count; ++i) {
+        ring.push(i);
+    }
+
+    while (received_count.load(std::memory_order_acquire) != item_count) {
+        std::this_thread::yield();
+    }
+
+    consumer.wait_until_finalized();
+    REQUIRE(in_place);
+
+    std::vector<std::size_t> expected(item_count);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(received == expected);
+}
+
+} // namespace tools::test
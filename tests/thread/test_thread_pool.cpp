@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/thread_pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+constexpr char TAGS[] = "[thread][thread_pool]";
+
+namespace tools::test {
+
+TEST_CASE("Tasks submitted to a thread pool all run", TAGS) {
+    const std::size_t thread_count = GENERATE(1, 4);
+    thread_pool pool(thread_count);
+    REQUIRE(pool.size() == thread_count);
+
+    std::vector<std::future<std::size_t>> results;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        results.push_back(pool.submit([i]{ return i * i; }));
+    }
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        CHECK(results[i].get() == i * i);
+    }
+}
+
+TEST_CASE("Thread pool tasks can be move-only", TAGS) {
+    thread_pool pool(2);
+
+    auto value = std::make_unique<int>(42);
+    auto result = pool.submit([value = std::move(value)]{ return *value; });
+
+    REQUIRE(result.get() == 42);
+}
+
+TEST_CASE("Exceptions thrown by thread pool tasks reach their future", TAGS) {
+    thread_pool pool(2);
+
+    auto result = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+
+    REQUIRE_THROWS_AS(result.get(), std::runtime_error);
+    // The pool keeps working afterwards
+    REQUIRE(pool.submit([]{ return 1; }).get() == 1);
+}
+
+TEST_CASE("A thread pool runs pending tasks before being destroyed", TAGS) {
+    std::atomic<std::size_t> count = 0;
+
+    {
+        thread_pool pool(3);
+        for (std::size_t i = 0; i < 10000; ++i) {
+            pool.post([&count]{ count.fetch_add(1, std::memory_order_relaxed); });
+        }
+    }
+
+    REQUIRE(count.load() == 10000);
+}
+
+TEST_CASE("Tasks can submit tasks to their own thread pool", TAGS) {
+    thread_pool pool(4);
+    std::atomic<std::size_t> count = 0;
+
+    auto outer = pool.submit([&]{
+        std::vector<std::future<void>> inner;
+        for (std::size_t i = 0; i < 100; ++i) {
+            inner.push_back(pool.submit([&count]{ count.fetch_add(1); }));
+        }
+
+        // Help instead of blocking, so that a single thread is enough
+        for (auto& f : inner) {
+            while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                pool.run_pending_task();
+            }
+        }
+    });
+
+    outer.get();
+    REQUIRE(count.load() == 100);
+}
+
+TEST_CASE("parallel_for visits every index of a range once", TAGS) {
+    const std::size_t thread_count = GENERATE(1, 4);
+    const std::size_t grain = GENERATE(0, 1, 7, 1000);
+    thread_pool pool(thread_count);
+
+    std::vector<std::atomic<int>> visits(10000);
+    pool.parallel_for(100, visits.size(), [&visits](std::size_t i) {
+        visits[i].fetch_add(1, std::memory_order_relaxed);
+    }, grain);
+
+    for (std::size_t i = 0; i < visits.size(); ++i) {
+        CHECK(visits[i].load() == (i < 100 ? 0 : 1));
+    }
+
+    SECTION("Empty ranges are a no-op") {
+        pool.parallel_for(5, 5, [](std::size_t) { FAIL("called on an empty range"); });
+    }
+}
+
+TEST_CASE("parallel_for can be nested", TAGS) {
+    thread_pool pool(2);
+
+    std::vector<std::size_t> sums(64, 0);
+    pool.parallel_for(0, sums.size(), [&](std::size_t i) {
+        std::atomic<std::size_t> sum = 0;
+        pool.parallel_for(0, 100, [&sum](std::size_t j) {
+            sum.fetch_add(j, std::memory_order_relaxed);
+        }, 10);
+        sums[i] = sum.load();
+    }, 1);
+
+    for (auto sum : sums) {
+        CHECK(sum == 4950);
+    }
+}
+
+TEST_CASE("parallel_for rethrows the first exception", TAGS) {
+    thread_pool pool(4);
+
+    REQUIRE_THROWS_AS(
+        pool.parallel_for(0, 10000, [](std::size_t i) {
+            if (i == 5000) {
+                throw std::out_of_range("index");
+            }
+        }, 10),
+        std::out_of_range
+    );
+
+    std::atomic<std::size_t> count = 0;
+    pool.parallel_for(0, 100, [&count](std::size_t) { count.fetch_add(1); });
+    REQUIRE(count.load() == 100);
+}
+
+} // namespace tools::test
@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+#include <cpptools/thread/worker.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+constexpr char TAGS[] = "[thread][worker]";
+
+namespace tools::test {
+
+namespace {
+
+std::atomic<std::size_t> task_calls = 0;
+std::atomic<std::size_t> start_calls = 0;
+std::atomic<std::size_t> finalize_calls = 0;
+std::atomic<std::size_t> resume_calls = 0;
+std::atomic<std::size_t> pause_calls = 0;
+
+void reset_calls() {
+    task_calls = 0;
+    start_calls = 0;
+    finalize_calls = 0;
+    resume_calls = 0;
+    pause_calls = 0;
+}
+
+void wait_for_task_calls(std::size_t count) {
+    while (task_calls.load() < count) {
+        std::this_thread::yield();
+    }
+}
+
+}
+
+TEST_CASE("A worker goes through its states as asked", TAGS) {
+    reset_calls();
+
+    worker w(
+        []{ task_calls.fetch_add(1); },
+        false,
+        []{ start_calls.fetch_add(1); },
+        []{ finalize_calls.fetch_add(1); },
+        []{ resume_calls.fetch_add(1); },
+        []{ pause_calls.fetch_add(1); }
+    );
+
+    // Not started right away: the worker pauses before its first task
+    w.wait_until_paused(false);
+    REQUIRE(w.paused());
+    REQUIRE_FALSE(w.running());
+    REQUIRE_FALSE(w.finalized());
+    REQUIRE(start_calls == 1);
+    REQUIRE(task_calls == 0);
+
+    w.wait_until_running();
+    REQUIRE(w.running());
+    wait_for_task_calls(10);
+    // Hooks run after the flags are updated, they are only known to be done
+    // once the next task runs
+    REQUIRE(pause_calls == 1);
+    REQUIRE(resume_calls == 1);
+
+    w.wait_until_paused();
+    REQUIRE(w.paused());
+    REQUIRE_FALSE(w.running());
+
+    // No task runs while paused
+    const std::size_t calls = task_calls;
+    std::this_thread::yield();
+    REQUIRE(task_calls == calls);
+
+    w.wait_until_running();
+    wait_for_task_calls(calls + 10);
+    REQUIRE(pause_calls == 2);
+    REQUIRE(resume_calls == 2);
+
+    w.wait_until_finalized();
+    REQUIRE(w.finalized());
+    REQUIRE(finalize_calls == 1);
+}
+
+TEST_CASE("A paused worker can be finalized", TAGS) {
+    reset_calls();
+
+    {
+        worker w([]{ task_calls.fetch_add(1); }, false, []{}, []{ finalize_calls.fetch_add(1); });
+        w.wait_until_paused(false);
+        w.wait_until_finalized();
+        REQUIRE(w.finalized());
+    }
+
+    REQUIRE(task_calls == 0);
+    REQUIRE(finalize_calls == 1);
+}
+
+TEST_CASE("A running worker is finalized when destroyed", TAGS) {
+    reset_calls();
+
+    {
+        worker w([]{ task_calls.fetch_add(1); }, true, []{}, []{ finalize_calls.fetch_add(1); });
+        wait_for_task_calls(100);
+    }
+
+    REQUIRE(finalize_calls == 1);
+}
+
+TEST_CASE("Workers can carry their own state", TAGS) {
+    SECTION("Move-only state") {
+        auto samples = std::make_unique<std::vector<std::size_t>>();
+        const auto* observed = samples.get();
+        std::size_t final_size = 0;
+
+        worker w(
+            [samples = std::move(samples)]{
+                if (samples->size() < 100) {
+                    samples->push_back(samples->size());
+                }
+            },
+            true,
+            []{},
+            [observed, &final_size]{ final_size = observed->size(); }
+        );
+
+        w.wait_until_running(false);
+        w.wait_until_finalized();
+
+        // The buffer is owned by the task, which lives as long as the worker
+        REQUIRE(observed->size() == final_size);
+        for (std::size_t i = 0; i < observed->size(); ++i) {
+            REQUIRE((*observed)[i] == i);
+        }
+    }
+
+    SECTION("Many workers with distinct state") {
+        constexpr std::size_t worker_count = 64;
+        std::vector<std::atomic<std::size_t>> counts(worker_count);
+        std::vector<std::unique_ptr<worker>> workers;
+
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            workers.push_back(std::make_unique<worker>(
+                [&count = counts[i], step = i + 1]{ count.fetch_add(step); }
+            ));
+        }
+
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            while (counts[i].load() < 10 * (i + 1)) {
+                std::this_thread::yield();
+            }
+            workers[i]->wait_until_finalized();
+
+            // Each worker only ever added its own step to its own count
+            REQUIRE(counts[i].load() % (i + 1) == 0);
+        }
+    }
+}
+
+} // namespace tools::test